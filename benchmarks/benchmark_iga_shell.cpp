@@ -0,0 +1,388 @@
+// Compares the blocked hessian scatter of IgaShell3PAD with the former scalar
+// loop and measures the element compute time for Bezier patches of degree
+// p = 2..4. The throughput of the pointwise and the batched evaluation of the
+// integration points is compared for IgaShell3PAD and IgaMembrane3PAD, and
+// the throughput of the AD elements with the analytic IgaShell3P and
+// IgaMembrane3P.
+
+#include <pybind11/eigen.h>
+#include <pybind11/embed.h>
+#include <pybind11/functional.h>
+#include <pybind11/numpy.h>
+#include <pybind11/operators.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <eqlib/Timer.h>
+#include <eqlib/objectives/IgaBlockedScatter.h>
+#include <eqlib/objectives/IgaMembrane3P.h>
+#include <eqlib/objectives/IgaMembrane3PAD.h>
+#include <eqlib/objectives/IgaShell3P.h>
+#include <eqlib/objectives/IgaShell3PAD.h>
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace eqlib {
+
+// derivatives of a function of 5 vectors with the interface of a hyperjet
+// scalar
+
+struct Derivatives {
+    Eigen::VectorXd m_g;
+    Eigen::MatrixXd m_h;
+
+    double g(const index i) const
+    {
+        return m_g(i);
+    }
+
+    double h(const index i, const index j) const
+    {
+        return m_h(i, j);
+    }
+};
+
+// scatter as implemented before the blocked products
+
+void scatter_loop(const Derivatives& result, const Matrix& shape_functions, Ref<Vector> g, Ref<Matrix> h)
+{
+    const index a = shape_functions.cols() * 3;
+
+    for (index r = 0; r < a; r++) {
+        const index rd = r % 3;
+        const index ri = r / 3;
+
+        for (index k = 0; k < 5; k++) {
+            g(r) += result.g(k * 3 + rd) * shape_functions(1 + k, ri);
+        }
+    }
+
+    for (index r = 0; r < a; r++) {
+        const index ri = r / 3;
+        const index rd = r % 3;
+
+        for (index s = r; s < a; s++) {
+            const index si = s / 3;
+            const index sd = s % 3;
+
+            for (index k = 0; k < 5; k++) {
+                for (index l = 0; l < 5; l++) {
+                    h(r, s) += result.h(k * 3 + rd, l * 3 + sd) * shape_functions(1 + k, ri) * shape_functions(1 + l, si);
+                }
+            }
+        }
+    }
+}
+
+// bernstein polynomials of degree p and their first two derivatives at t
+
+Matrix bernstein(const index p, const double t)
+{
+    Matrix values = Matrix::Zero(3, p + 1);
+
+    const auto binomial = [](const index n, const index k) {
+        return std::tgamma(n + 1.0) / (std::tgamma(k + 1.0) * std::tgamma(n - k + 1.0));
+    };
+
+    const auto b = [&](const index n, const index i) {
+        if (i < 0 || i > n) {
+            return 0.0;
+        }
+        return binomial(n, i) * std::pow(t, i) * std::pow(1 - t, n - i);
+    };
+
+    for (index i = 0; i <= p; i++) {
+        values(0, i) = b(p, i);
+        values(1, i) = p * (b(p - 1, i - 1) - b(p - 1, i));
+        values(2, i) = p > 1 ? p * (p - 1) * (b(p - 2, i - 2) - 2 * b(p - 2, i - 1) + b(p - 2, i)) : 0.0;
+    }
+
+    return values;
+}
+
+// rows: N, N_u, N_v, N_uu, N_uv, N_vv
+
+Matrix shape_functions(const index p, const double u, const double v)
+{
+    const Matrix bu = bernstein(p, u);
+    const Matrix bv = bernstein(p, v);
+
+    const index n = (p + 1) * (p + 1);
+
+    Matrix values(6, n);
+
+    for (index i = 0; i <= p; i++) {
+        for (index j = 0; j <= p; j++) {
+            const index k = i * (p + 1) + j;
+
+            values(0, k) = bu(0, i) * bv(0, j);
+            values(1, k) = bu(1, i) * bv(0, j);
+            values(2, k) = bu(0, i) * bv(1, j);
+            values(3, k) = bu(2, i) * bv(0, j);
+            values(4, k) = bu(1, i) * bv(1, j);
+            values(5, k) = bu(0, i) * bv(2, j);
+        }
+    }
+
+    return values;
+}
+
+template <typename TFunction>
+double measure(const index repetitions, TFunction&& function)
+{
+    Timer timer;
+
+    for (index i = 0; i < repetitions; i++) {
+        function();
+    }
+
+    return timer.ellapsed() / repetitions;
+}
+
+// nodes of a distorted Bezier patch of degree p
+
+std::vector<Pointer<Node>> create_nodes(const index p, std::mt19937& generator)
+{
+    std::uniform_real_distribution<double> distribution(-0.1, 0.1);
+
+    std::vector<Pointer<Node>> nodes;
+
+    for (index i = 0; i <= p; i++) {
+        for (index j = 0; j <= p; j++) {
+            auto node = std::make_shared<Node>(double(i) / p, double(j) / p, 0.0);
+            node->set_act_location(node->ref_location() + Vector3D(distribution(generator), distribution(generator), distribution(generator)));
+            nodes.push_back(node);
+        }
+    }
+
+    return nodes;
+}
+
+// (p + 1)^2 integration points
+
+template <typename TElement>
+void add_points(TElement& element, const index p)
+{
+    const index nb_nodes = (p + 1) * (p + 1);
+
+    for (index i = 0; i <= p; i++) {
+        for (index j = 0; j <= p; j++) {
+            element.add(shape_functions(p, (i + 0.5) / (p + 1), (j + 0.5) / (p + 1)), 1.0 / nb_nodes);
+        }
+    }
+}
+
+// time per call of the pointwise and the batched evaluation and the maximum
+// difference of the results
+
+template <int TOrder, typename TElement>
+void compare_batched(const char* name, const TElement& element, const index p)
+{
+    const index nb_nodes = (p + 1) * (p + 1);
+    const index a = nb_nodes * 3;
+
+    Vector g_pointwise = Vector::Zero(a);
+    Matrix h_pointwise = Matrix::Zero(TOrder > 1 ? a : 0, TOrder > 1 ? a : 0);
+
+    Vector g_batched = Vector::Zero(a);
+    Matrix h_batched = Matrix::Zero(TOrder > 1 ? a : 0, TOrder > 1 ? a : 0);
+
+    const index repetitions = 200;
+
+    double error = 0;
+
+    const auto [time_pointwise, time_batched] = iga_utilities::dispatch_nb_nodes(nb_nodes, [&](auto nb_nodes_t) {
+        constexpr int TNbNodes = decltype(nb_nodes_t)::value;
+
+        const double f_pointwise = element.template compute_pointwise<TOrder, TNbNodes>(g_pointwise, h_pointwise, NodeLocations::View());
+        const double f_batched = element.template compute_batched<TOrder, TNbNodes>(g_batched, h_batched, NodeLocations::View());
+
+        error = std::abs(f_pointwise - f_batched);
+        error = std::max(error, (g_pointwise - g_batched).cwiseAbs().maxCoeff());
+
+        if constexpr (TOrder > 1) {
+            error = std::max(error, (h_pointwise - h_batched).cwiseAbs().maxCoeff());
+        }
+
+        const double pointwise = measure(repetitions, [&]() {
+            element.template compute_pointwise<TOrder, TNbNodes>(g_pointwise, h_pointwise, NodeLocations::View());
+        });
+
+        const double batched = measure(repetitions, [&]() {
+            element.template compute_batched<TOrder, TNbNodes>(g_batched, h_batched, NodeLocations::View());
+        });
+
+        return std::make_pair(pointwise, batched);
+    });
+
+    const double nb_points = double(nb_nodes);
+
+    std::printf("%-10s %5d %2td %16.0f %16.0f %8.2f %12.2e\n", name, TOrder, p, nb_points / time_pointwise, nb_points / time_batched, time_pointwise / time_batched, error);
+}
+
+void run_batched()
+{
+    std::mt19937 generator(0);
+
+    std::printf("\n%-10s %5s %2s %16s %16s %8s %12s\n", "element", "order", "p", "pointwise [1/s]", "batched [1/s]", "speedup", "max error");
+
+    for (index p = 2; p <= 4; p++) {
+        const auto nodes = create_nodes(p, generator);
+
+        IgaShell3PAD shell(nodes, 0.1, 1'000, 0.3);
+        IgaMembrane3PAD membrane(nodes, 0.1, 1'000, 0.3);
+
+        add_points(shell, p);
+        add_points(membrane, p);
+
+        compare_batched<1>("shell", shell, p);
+        compare_batched<2>("shell", shell, p);
+        compare_batched<1>("membrane", membrane, p);
+        compare_batched<2>("membrane", membrane, p);
+    }
+}
+
+// time per call of the AD and the analytic element and the maximum
+// difference of the results
+
+template <int TOrder, typename TElementAD, typename TElement>
+void compare_analytic(const char* name, const TElementAD& element_ad, const TElement& element, const index p)
+{
+    const index nb_nodes = (p + 1) * (p + 1);
+    const index a = nb_nodes * 3;
+
+    Vector g_ad = Vector::Zero(a);
+    Matrix h_ad = Matrix::Zero(TOrder > 1 ? a : 0, TOrder > 1 ? a : 0);
+
+    Vector g = Vector::Zero(a);
+    Matrix h = Matrix::Zero(TOrder > 1 ? a : 0, TOrder > 1 ? a : 0);
+
+    const index repetitions = 200;
+
+    double error = std::abs(element_ad.template compute<TOrder>(g_ad, h_ad, NodeLocations::View()) - element.template compute<TOrder>(g, h, NodeLocations::View()));
+
+    error = std::max(error, (g_ad - g).cwiseAbs().maxCoeff());
+
+    if constexpr (TOrder > 1) {
+        error = std::max(error, (h_ad - h).cwiseAbs().maxCoeff());
+    }
+
+    const double time_ad = measure(repetitions, [&]() {
+        element_ad.template compute<TOrder>(g_ad, h_ad, NodeLocations::View());
+    });
+
+    const double time = measure(repetitions, [&]() {
+        element.template compute<TOrder>(g, h, NodeLocations::View());
+    });
+
+    const double nb_points = double(nb_nodes);
+
+    std::printf("%-10s %5d %2td %16.0f %16.0f %8.2f %12.2e\n", name, TOrder, p, nb_points / time_ad, nb_points / time, time_ad / time, error);
+}
+
+void run_analytic()
+{
+    std::mt19937 generator(0);
+
+    std::printf("\n%-10s %5s %2s %16s %16s %8s %12s\n", "element", "order", "p", "AD [1/s]", "analytic [1/s]", "speedup", "max error");
+
+    for (index p = 2; p <= 4; p++) {
+        const auto nodes = create_nodes(p, generator);
+
+        IgaShell3PAD shell_ad(nodes, 0.1, 1'000, 0.3);
+        IgaShell3P shell(nodes, 0.1, 1'000, 0.3);
+        IgaMembrane3PAD membrane_ad(nodes, 0.1, 1'000, 0.3);
+        IgaMembrane3P membrane(nodes, 0.1, 1'000, 0.3);
+
+        add_points(shell_ad, p);
+        add_points(shell, p);
+        add_points(membrane_ad, p);
+        add_points(membrane, p);
+
+        compare_analytic<1>("shell", shell_ad, shell, p);
+        compare_analytic<2>("shell", shell_ad, shell, p);
+        compare_analytic<1>("membrane", membrane_ad, membrane, p);
+        compare_analytic<2>("membrane", membrane_ad, membrane, p);
+    }
+}
+
+void run()
+{
+    std::mt19937 generator(0);
+
+    std::printf("%2s %6s %14s %14s %8s %12s %14s\n", "p", "nodes", "loop [us]", "blocked [us]", "speedup", "max error", "element [us]");
+
+    for (index p = 2; p <= 4; p++) {
+        const index nb_nodes = (p + 1) * (p + 1);
+        const index a = nb_nodes * 3;
+
+        // scatter of a single integration point
+
+        const Matrix n = shape_functions(p, 0.3, 0.6);
+
+        Derivatives result;
+        result.m_g = Eigen::VectorXd::Random(15);
+        result.m_h = Eigen::MatrixXd::Random(15, 15);
+        result.m_h = (result.m_h + result.m_h.transpose()).eval();
+
+        Vector g_loop = Vector::Zero(a);
+        Matrix h_loop = Matrix::Zero(a, a);
+
+        Vector g_blocked = Vector::Zero(a);
+        Matrix h_blocked = Matrix::Zero(a, a);
+
+        const index repetitions = 2'000;
+
+        const double time_loop = measure(repetitions, [&]() {
+            scatter_loop(result, n, g_loop, h_loop);
+        });
+
+        // use the same specialization as the element
+
+        const double time_blocked = iga_utilities::dispatch_nb_nodes(nb_nodes, [&](auto nb_nodes_t) {
+            IgaBlockedScatter<5, decltype(nb_nodes_t)::value> scatter(nb_nodes);
+
+            return measure(repetitions, [&]() {
+                scatter.set_shape_functions(n.bottomRows(5));
+                scatter.add_gradient(result, g_blocked);
+                scatter.add_hessian(result, h_blocked);
+            });
+        });
+
+        const Matrix upper_loop = h_loop.triangularView<Eigen::Upper>();
+        const Matrix upper_blocked = h_blocked.triangularView<Eigen::Upper>();
+
+        const double error = std::max((g_loop - g_blocked).cwiseAbs().maxCoeff(), (upper_loop - upper_blocked).cwiseAbs().maxCoeff()) / repetitions;
+
+        // element with (p + 1)^2 integration points
+
+        IgaShell3PAD element(create_nodes(p, generator), 0.1, 1'000, 0.3);
+
+        add_points(element, p);
+
+        Vector g = Vector::Zero(a);
+        Matrix h = Matrix::Zero(a, a);
+
+        const double time_element = measure(200, [&]() {
+            element.compute(g, h);
+        });
+
+        std::printf("%2td %6td %14.3f %14.3f %8.2f %12.2e %14.3f\n", p, nb_nodes, time_loop * 1e6, time_blocked * 1e6, time_loop / time_blocked, error, time_element * 1e6);
+    }
+}
+
+} // namespace eqlib
+
+int main()
+{
+    pybind11::scoped_interpreter guard;
+
+    eqlib::run();
+    eqlib::run_batched();
+    eqlib::run_analytic();
+
+    return 0;
+}
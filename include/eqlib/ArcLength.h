@@ -0,0 +1,648 @@
+#pragma once
+
+#include "Define.h"
+#include "LinearSolver.h"
+#include "Log.h"
+#include "Parameter.h"
+#include "Problem.h"
+#include "Timer.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+namespace eqlib {
+
+/*
+* Arc-length path following after Crisfield: A fast incremental/iterative
+* solution procedure that handles "snap-through" (1981).
+*
+* The parameter is treated as the load factor lambda. Each step satisfies
+* |dx|^2 + psi^2 dlambda^2 = ds^2. psi = 0 gives the cylindrical and psi = 1
+* the spherical arc-length method.
+*
+* Every corrector iteration factorizes the hessian once and uses the factor
+* for two solves: one against the residual and one against the derivative of
+* the residual with respect to the parameter (bordered solve).
+*
+* Critical points are detected by a change of the number of negative pivots
+* of the LDLT factorization between two converged states. This requires a
+* linear solver providing nb_negative_pivots.
+*/
+class ArcLength {
+private: // types
+    using Type = eqlib::ArcLength;
+    using Sensitivity = std::function<Vector()>;
+    using IndexVector = Eigen::Matrix<index, 1, Eigen::Dynamic>;
+
+private: // members
+    Pointer<Problem> m_problem;
+    Pointer<Parameter> m_parameter;
+    Sensitivity m_sensitivity;
+    index m_maxsteps;
+    index m_maxiter;
+    index m_desired_iterations;
+    index m_max_cutbacks;
+    index m_fevals;
+    index m_gevals;
+    index m_hevals;
+    double m_rtol;
+    double m_step;
+    double m_min_step;
+    double m_max_step;
+    double m_psi;
+    double m_max_parameter;
+    double m_fd_step;
+    double m_direction;
+    index m_stopping_reason;
+
+    std::vector<double> m_path_parameters;
+    std::vector<double> m_path_states;
+    std::vector<double> m_path_step_sizes;
+    std::vector<index> m_path_iterations;
+    std::vector<index> m_path_negative_pivots;
+    std::vector<double> m_path_times;
+    std::vector<index> m_critical_points;
+
+    Vector m_x_converged;
+    Vector m_dx;
+    Vector m_dx_last;
+    Vector m_delta_r;
+    Vector m_delta_t;
+    Vector m_df_0;
+    Vector m_df_lambda;
+    Vector m_residual;
+
+private: // methods
+    LinearSolver& linear_solver()
+    {
+        return *m_problem->linear_solver();
+    }
+
+    bool factorize()
+    {
+        Trace::Span span("factorize");
+
+        return linear_solver().factorize(m_problem->hm_indptr(), m_problem->hm_indices(), m_problem->hm_values());
+    }
+
+    bool solve(Ref<const Vector> b, Ref<Vector> x)
+    {
+        Trace::Span span("solve");
+
+        return linear_solver().solve(m_problem->hm_indptr(), m_problem->hm_indices(), m_problem->hm_values(), b, x);
+    }
+
+    // expects df of the current state in the problem, leaves hm untouched
+
+    void compute_df_lambda()
+    {
+        if (m_sensitivity) {
+            m_df_lambda = m_sensitivity();
+
+            if (length(m_df_lambda) != m_problem->nb_variables()) {
+                throw std::runtime_error("Sensitivity has an invalid size");
+            }
+        } else {
+            const double lambda = m_parameter->value();
+            const double h = m_fd_step * std::max(1.0, std::abs(lambda));
+
+            m_df_0 = m_problem->df();
+
+            m_parameter->set_value(lambda + h);
+            m_problem->compute<false, 1>();
+            m_fevals += 1;
+            m_gevals += 1;
+            m_parameter->set_value(lambda);
+
+            m_df_lambda = (m_problem->df() - m_df_0) / h;
+
+            m_problem->df() = m_df_0;
+        }
+    }
+
+    // returns the negative pivots of the current state or -2 on failure
+
+    index factorize_and_compute_tangent()
+    {
+        compute_df_lambda();
+
+        if (factorize() || solve(m_df_lambda, m_delta_t)) {
+            return -2;
+        }
+
+        m_delta_t *= -1.0;
+
+        return linear_solver().nb_negative_pivots();
+    }
+
+    void set_state(const double lambda_0, const double dlambda)
+    {
+        m_problem->set_x(m_x_converged + m_dx);
+        m_parameter->set_value(lambda_0 + dlambda);
+    }
+
+    // returns the number of iterations or -1 if the corrector failed
+
+    index correct(const double lambda_0, double& dlambda, const double ds)
+    {
+        const double psi2 = m_psi * m_psi;
+
+        for (index iteration = 0; iteration < m_maxiter; iteration++) {
+            Trace::Span iteration_span("ArcLength iteration");
+
+            m_problem->compute<false, 2>();
+            m_fevals += 1;
+            m_gevals += 1;
+            m_hevals += 1;
+
+            const double rnorm = m_problem->df().norm();
+
+            Log::task_info("Iteration {}: rnorm = {}", iteration + 1, rnorm);
+
+            if (!std::isfinite(rnorm)) {
+                return -1;
+            }
+
+            if (rnorm < m_rtol) {
+                return iteration;
+            }
+
+            // bordered solve: one factorization, two solves
+
+            m_residual = m_problem->df();
+
+            if (factorize_and_compute_tangent() == -2 || solve(m_residual, m_delta_r)) {
+                return -1;
+            }
+
+            m_delta_r *= -1.0;
+
+            // solve the constraint for the change of the parameter
+
+            m_residual = m_dx + m_delta_r;
+
+            const double a = m_delta_t.squaredNorm() + psi2;
+            const double b = 2.0 * (m_residual.dot(m_delta_t) + psi2 * dlambda);
+            const double c = m_residual.squaredNorm() + psi2 * dlambda * dlambda - ds * ds;
+
+            const double discriminant = b * b - 4.0 * a * c;
+
+            if (discriminant < 0.0) {
+                Log::task_info("Arc-length constraint has no real solution");
+                return -1;
+            }
+
+            const double root = std::sqrt(discriminant);
+            const double q = -0.5 * (b + std::copysign(root, b));
+
+            const double ddlambda_1 = q / a;
+            const double ddlambda_2 = q != 0.0 ? c / q : ddlambda_1;
+
+            // take the root keeping the direction of the increment
+
+            const double dot_1 = (m_residual + ddlambda_1 * m_delta_t).dot(m_dx) + psi2 * (dlambda + ddlambda_1) * dlambda;
+            const double dot_2 = (m_residual + ddlambda_2 * m_delta_t).dot(m_dx) + psi2 * (dlambda + ddlambda_2) * dlambda;
+
+            const double ddlambda = dot_1 >= dot_2 ? ddlambda_1 : ddlambda_2;
+
+            m_dx = m_residual + ddlambda * m_delta_t;
+            dlambda += ddlambda;
+
+            set_state(lambda_0, dlambda);
+        }
+
+        return -1;
+    }
+
+    void record_point(const double step_size, const index iterations, const index negative_pivots, const double time)
+    {
+        const Vector x = m_problem->x();
+
+        m_path_parameters.push_back(m_parameter->value());
+        m_path_states.insert(m_path_states.end(), x.data(), x.data() + x.size());
+        m_path_step_sizes.push_back(step_size);
+        m_path_iterations.push_back(iterations);
+        m_path_negative_pivots.push_back(negative_pivots);
+        m_path_times.push_back(time);
+    }
+
+public: // constructor
+    ArcLength(Pointer<Problem> problem, Pointer<Parameter> parameter)
+        : m_problem(problem)
+        , m_parameter(parameter)
+        , m_maxsteps(100)
+        , m_maxiter(20)
+        , m_desired_iterations(4)
+        , m_max_cutbacks(10)
+        , m_fevals(0)
+        , m_gevals(0)
+        , m_hevals(0)
+        , m_rtol(1e-6)
+        , m_step(1.0)
+        , m_min_step(1e-8)
+        , m_max_step(infinity)
+        , m_psi(1.0)
+        , m_max_parameter(infinity)
+        , m_fd_step(1e-7)
+        , m_direction(1.0)
+        , m_stopping_reason(-1)
+    {
+        if (problem->is_constrained()) {
+            throw std::runtime_error("Constraints are not supported");
+        }
+    }
+
+public: // methods
+    Sensitivity sensitivity() const noexcept
+    {
+        return m_sensitivity;
+    }
+
+    void set_sensitivity(const Sensitivity& value) noexcept
+    {
+        m_sensitivity = value;
+    }
+
+    index maxsteps() const noexcept
+    {
+        return m_maxsteps;
+    }
+
+    void set_maxsteps(const index value) noexcept
+    {
+        m_maxsteps = value;
+    }
+
+    index maxiter() const noexcept
+    {
+        return m_maxiter;
+    }
+
+    void set_maxiter(const index value) noexcept
+    {
+        m_maxiter = value;
+    }
+
+    index desired_iterations() const noexcept
+    {
+        return m_desired_iterations;
+    }
+
+    void set_desired_iterations(const index value) noexcept
+    {
+        m_desired_iterations = value;
+    }
+
+    index max_cutbacks() const noexcept
+    {
+        return m_max_cutbacks;
+    }
+
+    void set_max_cutbacks(const index value) noexcept
+    {
+        m_max_cutbacks = value;
+    }
+
+    double rtol() const noexcept
+    {
+        return m_rtol;
+    }
+
+    void set_rtol(const double value) noexcept
+    {
+        m_rtol = value;
+    }
+
+    double step() const noexcept
+    {
+        return m_step;
+    }
+
+    void set_step(const double value) noexcept
+    {
+        m_step = value;
+    }
+
+    double min_step() const noexcept
+    {
+        return m_min_step;
+    }
+
+    void set_min_step(const double value) noexcept
+    {
+        m_min_step = value;
+    }
+
+    double max_step() const noexcept
+    {
+        return m_max_step;
+    }
+
+    void set_max_step(const double value) noexcept
+    {
+        m_max_step = value;
+    }
+
+    double psi() const noexcept
+    {
+        return m_psi;
+    }
+
+    void set_psi(const double value) noexcept
+    {
+        m_psi = value;
+    }
+
+    double max_parameter() const noexcept
+    {
+        return m_max_parameter;
+    }
+
+    void set_max_parameter(const double value) noexcept
+    {
+        m_max_parameter = value;
+    }
+
+    double fd_step() const noexcept
+    {
+        return m_fd_step;
+    }
+
+    void set_fd_step(const double value) noexcept
+    {
+        m_fd_step = value;
+    }
+
+    double direction() const noexcept
+    {
+        return m_direction;
+    }
+
+    void set_direction(const double value)
+    {
+        if (value == 0.0) {
+            throw std::invalid_argument("Direction must not be zero");
+        }
+
+        m_direction = std::copysign(1.0, value);
+    }
+
+    index fevals() const noexcept
+    {
+        return m_fevals;
+    }
+
+    index gevals() const noexcept
+    {
+        return m_gevals;
+    }
+
+    index hevals() const noexcept
+    {
+        return m_hevals;
+    }
+
+    index stopping_reason() const noexcept
+    {
+        return m_stopping_reason;
+    }
+
+    index nb_points() const noexcept
+    {
+        return length(m_path_parameters);
+    }
+
+    Vector path_parameters() const
+    {
+        return Map<const Vector>(m_path_parameters.data(), nb_points());
+    }
+
+    Matrix path_states() const
+    {
+        return Map<const Matrix>(m_path_states.data(), nb_points(), m_problem->nb_variables());
+    }
+
+    Vector path_step_sizes() const
+    {
+        return Map<const Vector>(m_path_step_sizes.data(), nb_points());
+    }
+
+    IndexVector path_iterations() const
+    {
+        return Map<const IndexVector>(m_path_iterations.data(), nb_points());
+    }
+
+    IndexVector path_negative_pivots() const
+    {
+        return Map<const IndexVector>(m_path_negative_pivots.data(), nb_points());
+    }
+
+    Vector path_times() const
+    {
+        return Map<const Vector>(m_path_times.data(), nb_points());
+    }
+
+    IndexVector critical_points() const
+    {
+        return Map<const IndexVector>(m_critical_points.data(), length(m_critical_points));
+    }
+
+    void run()
+    {
+        // setup
+
+        Log::task_begin("Following equilibrium path using arc-length method...");
+
+        Timer timer;
+
+        const index n = m_problem->nb_variables();
+
+        m_fevals = 0;
+        m_gevals = 0;
+        m_hevals = 0;
+        m_stopping_reason = 0;
+
+        m_path_parameters.clear();
+        m_path_states.clear();
+        m_path_step_sizes.clear();
+        m_path_iterations.clear();
+        m_path_negative_pivots.clear();
+        m_path_times.clear();
+        m_critical_points.clear();
+
+        m_x_converged.resize(n);
+        m_dx.resize(n);
+        m_dx_last = Vector::Zero(n);
+        m_delta_r.resize(n);
+        m_delta_t.resize(n);
+        m_df_0.resize(n);
+        m_df_lambda.resize(n);
+        m_residual.resize(n);
+
+        // initial state
+
+        m_problem->compute<false, 2>();
+        m_fevals += 1;
+        m_gevals += 1;
+        m_hevals += 1;
+
+        index negative_pivots = factorize_and_compute_tangent();
+
+        if (negative_pivots == -2) {
+            m_stopping_reason = 2;
+            Log::task_end("Stopped because the initial state could not be factorized");
+            return;
+        }
+
+        record_point(0.0, 0, negative_pivots, 0.0);
+
+        double dlambda_last = 0.0;
+        double ds = m_step;
+
+        for (index step = 0; step < m_maxsteps; step++) {
+            if (std::abs(m_parameter->value()) >= m_max_parameter) {
+                Log::task_info("Stopped because |parameter| >= {}", m_max_parameter);
+                break;
+            }
+
+            Timer step_timer;
+
+            Log::task_step("Step {} with parameter = {}...", step + 1, m_parameter->value());
+
+            const double lambda_0 = m_parameter->value();
+            m_x_converged = m_problem->x();
+
+            // m_delta_t holds the tangent of the converged state
+
+            const double psi2 = m_psi * m_psi;
+
+            double sign = step == 0 ? m_direction : std::copysign(1.0, m_delta_t.dot(m_dx_last) + psi2 * dlambda_last);
+
+            index cutbacks = 0;
+            index iterations = -1;
+            double dlambda = 0.0;
+
+            while (true) {
+                ds = std::min(ds, m_max_step);
+
+                // predictor
+
+                dlambda = sign * ds / std::sqrt(m_delta_t.squaredNorm() + psi2);
+                m_dx = dlambda * m_delta_t;
+
+                set_state(lambda_0, dlambda);
+
+                // corrector
+
+                iterations = correct(lambda_0, dlambda, ds);
+
+                if (iterations >= 0) {
+                    break;
+                }
+
+                m_problem->set_x(m_x_converged);
+                m_parameter->set_value(lambda_0);
+
+                ds *= 0.5;
+                cutbacks += 1;
+
+                Log::task_info("Corrector failed. Cut back arc length to {}", ds);
+
+                if (cutbacks > m_max_cutbacks || ds < m_min_step) {
+                    break;
+                }
+
+                // restore the tangent of the converged state
+
+                m_problem->compute<false, 2>();
+                m_fevals += 1;
+                m_gevals += 1;
+                m_hevals += 1;
+
+                if (factorize_and_compute_tangent() == -2) {
+                    break;
+                }
+            }
+
+            if (iterations < 0) {
+                m_stopping_reason = 1;
+                Log::task_end("Stopped at parameter = {} because the arc length could not be reduced further", lambda_0);
+                return;
+            }
+
+            // factorize the converged state for the inertia and the next predictor
+
+            const index last_negative_pivots = negative_pivots;
+
+            negative_pivots = factorize_and_compute_tangent();
+
+            if (negative_pivots == -2) {
+                m_stopping_reason = 2;
+                Log::task_end("Stopped because the converged state could not be factorized");
+                return;
+            }
+
+            record_point(ds, iterations, negative_pivots, step_timer.ellapsed());
+
+            if (negative_pivots != last_negative_pivots && negative_pivots >= 0 && last_negative_pivots >= 0) {
+                m_critical_points.push_back(nb_points() - 1);
+                Log::task_info("Passed a critical point: number of negative pivots changed from {} to {}", last_negative_pivots, negative_pivots);
+            }
+
+            m_dx_last = m_dx;
+            dlambda_last = dlambda;
+
+            // adapt arc length to the number of corrector iterations
+
+            const double ratio = double(m_desired_iterations) / std::max(index(1), iterations);
+
+            ds *= std::clamp(std::sqrt(ratio), 0.5, 2.0);
+        }
+
+        Log::task_end("Path traced in {:.3f} sec", timer.ellapsed());
+    }
+
+public: // python
+    template <typename TModule>
+    static void register_python(TModule& m)
+    {
+        namespace py = pybind11;
+        using namespace pybind11::literals;
+
+        py::class_<Type>(m, "ArcLength")
+            .def(py::init<Pointer<eqlib::Problem>, Pointer<eqlib::Parameter>>(), "problem"_a, "parameter"_a)
+            .def("run", &Type::run, py::call_guard<py::gil_scoped_release>())
+            // properties
+            .def_property("desired_iterations", &Type::desired_iterations, &Type::set_desired_iterations)
+            .def_property("direction", &Type::direction, &Type::set_direction)
+            .def_property("fd_step", &Type::fd_step, &Type::set_fd_step)
+            .def_property("max_cutbacks", &Type::max_cutbacks, &Type::set_max_cutbacks)
+            .def_property("max_parameter", &Type::max_parameter, &Type::set_max_parameter)
+            .def_property("max_step", &Type::max_step, &Type::set_max_step)
+            .def_property("maxiter", &Type::maxiter, &Type::set_maxiter)
+            .def_property("maxsteps", &Type::maxsteps, &Type::set_maxsteps)
+            .def_property("min_step", &Type::min_step, &Type::set_min_step)
+            .def_property("psi", &Type::psi, &Type::set_psi)
+            .def_property("rtol", &Type::rtol, &Type::set_rtol)
+            .def_property("sensitivity", &Type::sensitivity, &Type::set_sensitivity)
+            .def_property("step", &Type::step, &Type::set_step)
+            // read-only properties
+            .def_property_readonly("critical_points", &Type::critical_points)
+            .def_property_readonly("nb_points", &Type::nb_points)
+            .def_property_readonly("path_iterations", &Type::path_iterations)
+            .def_property_readonly("path_negative_pivots", &Type::path_negative_pivots)
+            .def_property_readonly("path_parameters", &Type::path_parameters)
+            .def_property_readonly("path_states", &Type::path_states)
+            .def_property_readonly("path_step_sizes", &Type::path_step_sizes)
+            .def_property_readonly("path_times", &Type::path_times)
+            .def_property_readonly("stopping_reason", &Type::stopping_reason)
+            .def_property_readonly("fevals", &Type::fevals)
+            .def_property_readonly("gevals", &Type::gevals)
+            .def_property_readonly("hevals", &Type::hevals);
+    }
+}; // class ArcLength
+
+} // namespace eqlib
@@ -0,0 +1,245 @@
+#pragma once
+
+#include "Define.h"
+#include "Objective.h"
+#include "Variable.h"
+
+#include <pybind11/numpy.h>
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace eqlib {
+
+/*
+* A group of objectives with the same number of variables which are computed
+* by a single callback. The callback gets the values of the variables of all
+* elements stacked into an array x of shape (nb_elements, nb_variables) and
+* fills g with shape (nb_elements, nb_variables) and h with shape
+* (nb_elements, nb_variables, nb_variables). It returns the values of f. g and
+* h are empty if they are not requested. The arrays share the memory of the
+* batch and keep it alive, so they are overwritten by the next computation.
+*
+* The problem calls the batch once at the beginning of each computation. The
+* elements only copy their results into the usual assembly, so they do not
+* need the GIL.
+*/
+class BatchObjective {
+private: // types
+    using Type = BatchObjective;
+    using Array = pybind11::array_t<double>;
+    using ComputeFunction = std::function<pybind11::object(Array, Array, Array)>;
+
+public: // types
+    class Batch : public std::enable_shared_from_this<Batch> {
+    private: // variables
+        std::vector<std::vector<Pointer<Variable>>> m_variables;
+        ComputeFunction m_compute;
+
+        index m_nb_variables;
+
+        Vector m_x;
+        Vector m_f;
+        Vector m_g;
+        Vector m_h;
+
+    public: // constructors
+        Batch(
+            const std::vector<std::vector<Pointer<Variable>>>& variables,
+            ComputeFunction compute)
+            : m_variables(variables)
+            , m_compute(compute)
+            , m_nb_variables(variables.empty() ? 0 : length(variables.front()))
+        {
+            for (const auto& element_variables : m_variables) {
+                if (length(element_variables) != m_nb_variables) {
+                    throw std::invalid_argument("All elements of a batch must have the same number of variables");
+                }
+            }
+
+            const index nb_elements = length(m_variables);
+
+            m_x.resize(nb_elements * m_nb_variables);
+            m_f.resize(nb_elements);
+            m_g.setZero(nb_elements * m_nb_variables);
+            m_h.setZero(nb_elements * m_nb_variables * m_nb_variables);
+        }
+
+    private: // methods
+        Array view(Vector& values, const std::vector<index>& shape)
+        {
+            namespace py = pybind11;
+
+            // the capsule prevents numpy from copying the buffer and holds the
+            // batch, so the array stays valid if the callback keeps it
+
+            py::capsule base(new Pointer<Batch>(shared_from_this()), [](void* batch) {
+                delete static_cast<Pointer<Batch>*>(batch);
+            });
+
+            return Array(shape, values.data(), base);
+        }
+
+    public: // methods
+        index nb_elements() const noexcept
+        {
+            return length(m_variables);
+        }
+
+        index nb_variables() const noexcept
+        {
+            return m_nb_variables;
+        }
+
+        const std::vector<Pointer<Variable>>& variables(const index i) const
+        {
+            return m_variables[i];
+        }
+
+        // calls the callback for all elements. The GIL is acquired only for
+        // the call itself
+
+        void compute(const index order)
+        {
+            namespace py = pybind11;
+
+            const index n = m_nb_variables;
+
+            for (index i = 0; i < nb_elements(); i++) {
+                for (index j = 0; j < n; j++) {
+                    m_x(i * n + j) = m_variables[i][j]->value();
+                }
+            }
+
+            const index n_g = order > 0 ? n : 0;
+            const index n_h = order > 1 ? n : 0;
+
+            // entries that the callback does not write are zero
+
+            m_g.head(nb_elements() * n_g).setZero();
+            m_h.head(nb_elements() * n_h * n_h).setZero();
+
+            py::gil_scoped_acquire acquire;
+
+            const py::object f = m_compute(
+                view(m_x, {nb_elements(), n}),
+                view(m_g, {nb_elements(), n_g}),
+                view(m_h, {nb_elements(), n_h, n_h}));
+
+            const Vector values = f.cast<Vector>();
+
+            if (length(values) != nb_elements()) {
+                throw std::runtime_error(format("The batch returned {} values for {} elements", length(values), nb_elements()));
+            }
+
+            m_f = values;
+        }
+
+        // copies the results of element i
+
+        double compute(const index i, Ref<Vector> g, Ref<Matrix> h) const
+        {
+            const index n = m_nb_variables;
+
+            if (g.size() != 0) {
+                g = m_g.segment(i * n, n);
+            }
+
+            if (h.size() != 0) {
+                h = Map<const Matrix>(m_h.data() + i * n * n, n, n);
+            }
+
+            return m_f(i);
+        }
+    };
+
+    class Element : public Objective {
+    private: // variables
+        Pointer<Batch> m_batch;
+        index m_index;
+
+    public: // constructors
+        Element(const Pointer<Batch>& batch, const index i)
+            : Objective()
+            , m_batch(batch)
+            , m_index(i)
+        {
+            m_variables = batch->variables(i);
+        }
+
+    public: // methods
+        const Pointer<Batch>& batch() const noexcept
+        {
+            return m_batch;
+        }
+
+        // returns the results of the last computation of the batch
+
+        double compute(Ref<Vector> g, Ref<Matrix> h) const override
+        {
+            return m_batch->compute(m_index, g, h);
+        }
+    };
+
+private: // variables
+    Pointer<Batch> m_batch;
+    std::vector<Pointer<Objective>> m_elements;
+
+public: // constructors
+    BatchObjective(
+        const std::vector<std::vector<Pointer<Variable>>>& variables,
+        ComputeFunction compute)
+        : m_batch(new_<Batch>(variables, compute))
+    {
+        m_elements.reserve(m_batch->nb_elements());
+
+        for (index i = 0; i < m_batch->nb_elements(); i++) {
+            m_elements.push_back(new_<Element>(m_batch, i));
+        }
+    }
+
+public: // methods
+    index nb_elements() const noexcept
+    {
+        return m_batch->nb_elements();
+    }
+
+    index nb_variables() const noexcept
+    {
+        return m_batch->nb_variables();
+    }
+
+    const std::vector<Pointer<Objective>>& elements() const noexcept
+    {
+        return m_elements;
+    }
+
+    void compute(const index order)
+    {
+        m_batch->compute(order);
+    }
+
+public: // python
+    template <typename TModule>
+    static void register_python(TModule& m)
+    {
+        namespace py = pybind11;
+        using namespace pybind11::literals;
+
+        using Holder = Pointer<Type>;
+
+        py::class_<Type, Holder>(m, "BatchObjective")
+            // constructors
+            .def(py::init<const std::vector<std::vector<Pointer<Variable>>>&, ComputeFunction>(), "variables"_a, "compute"_a)
+            // read-only properties
+            .def_property_readonly("nb_elements", &Type::nb_elements)
+            .def_property_readonly("nb_variables", &Type::nb_variables)
+            .def_property_readonly("elements", &Type::elements)
+            // methods
+            .def("compute", &Type::compute, "order"_a = 2, py::call_guard<py::gil_scoped_release>());
+    }
+};
+
+} // namespace eqlib
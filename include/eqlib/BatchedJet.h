@@ -0,0 +1,263 @@
+#pragma once
+
+#include "Define.h"
+
+#include <Eigen/Core>
+
+#include <array>
+
+namespace eqlib {
+
+/*
+* Forward mode automatic differentiation of TLanes independent evaluations in
+* lockstep.
+*
+* The value and the derivatives of all lanes are stored with the lane index
+* innermost, so every operation on a derivative is a short vector operation
+* over the lanes. Only the upper triangle of the hessian is stored and
+* TOrder = 1 stores no hessian at all.
+*/
+template <int TOrder, int TLanes, int TSize>
+class BatchedJet {
+    static_assert(1 <= TOrder && TOrder <= 2);
+    static_assert(1 < TLanes);
+
+public: // types
+    using Type = BatchedJet<TOrder, TLanes, TSize>;
+
+    static constexpr int NbHessian = TOrder > 1 ? TSize * (TSize + 1) / 2 : 0;
+
+    using Lanes = Eigen::Array<double, TLanes, 1>;
+    using Gradient = Eigen::Array<double, TLanes, TSize, Eigen::ColMajor>;
+    using Hessian = Eigen::Array<double, TLanes, NbHessian, Eigen::ColMajor>;
+
+    using Vector3 = std::array<Type, 3>;
+
+    // derivatives of a single lane with the interface of a hyperjet scalar
+
+    class Lane {
+    private: // variables
+        const Type& m_jet;
+        index m_lane;
+
+    public: // constructor
+        Lane(const Type& jet, const index lane)
+            : m_jet(jet)
+            , m_lane(lane)
+        {
+        }
+
+    public: // methods
+        double f() const
+        {
+            return m_jet.m_f(m_lane);
+        }
+
+        double g(const index i) const
+        {
+            return m_jet.m_g(m_lane, i);
+        }
+
+        double h(const index i, const index j) const
+        {
+            return i <= j ? m_jet.m_h(m_lane, hessian_index(i, j)) : m_jet.m_h(m_lane, hessian_index(j, i));
+        }
+    };
+
+private: // variables
+    Lanes m_f;
+    Gradient m_g;
+    Hessian m_h;
+
+private: // methods
+    static constexpr index hessian_index(const index i, const index j) noexcept
+    {
+        return i * TSize - i * (i - 1) / 2 + j - i;
+    }
+
+    // chain rule for a scalar function with the derivatives d1 and d2
+
+    static Type apply(const Type& a, const Lanes& f, const Lanes& d1, const Lanes& d2)
+    {
+        Type result;
+
+        result.m_f = f;
+        result.m_g = a.m_g.colwise() * d1;
+
+        if constexpr (TOrder > 1) {
+            result.m_h = a.m_h.colwise() * d1;
+
+            index k = 0;
+
+            for (index i = 0; i < TSize; i++) {
+                const Lanes d2_gi = d2 * a.m_g.col(i);
+
+                for (index j = i; j < TSize; j++, k++) {
+                    result.m_h.col(k) += d2_gi * a.m_g.col(j);
+                }
+            }
+        }
+
+        return result;
+    }
+
+public: // constructors
+    BatchedJet() = default;
+
+    static Type constant(const Lanes& f)
+    {
+        Type result;
+
+        result.m_f = f;
+        result.m_g.setZero();
+        result.m_h.setZero();
+
+        return result;
+    }
+
+    template <typename TValue>
+    static Type variable(const index i, const TValue& f)
+    {
+        Type result = constant(f);
+
+        result.m_g.col(i).setOnes();
+
+        return result;
+    }
+
+    // the variables TOffset to TOffset + 2 with the values of the columns of x
+
+    template <index TOffset, typename TValues>
+    static Vector3 variables(const TValues& x)
+    {
+        return {variable(TOffset, x.col(TOffset)), variable(TOffset + 1, x.col(TOffset + 1)), variable(TOffset + 2, x.col(TOffset + 2))};
+    }
+
+public: // methods
+    const Lanes& f() const noexcept
+    {
+        return m_f;
+    }
+
+    Lane lane(const index i) const
+    {
+        return Lane(*this, i);
+    }
+
+    Type& operator+=(const Type& b)
+    {
+        m_f += b.m_f;
+        m_g += b.m_g;
+        m_h += b.m_h;
+        return *this;
+    }
+
+    Type& operator*=(const Lanes& b)
+    {
+        m_f *= b;
+        m_g.colwise() *= b;
+        m_h.colwise() *= b;
+        return *this;
+    }
+
+    Type& operator*=(const double b)
+    {
+        m_f *= b;
+        m_g *= b;
+        m_h *= b;
+        return *this;
+    }
+
+    friend Type operator+(Type a, const Type& b)
+    {
+        return a += b;
+    }
+
+    friend Type operator-(Type a, const Type& b)
+    {
+        a.m_f -= b.m_f;
+        a.m_g -= b.m_g;
+        a.m_h -= b.m_h;
+        return a;
+    }
+
+    friend Type operator-(Type a, const Lanes& b)
+    {
+        a.m_f -= b;
+        return a;
+    }
+
+    friend Type operator*(Type a, const Lanes& b)
+    {
+        return a *= b;
+    }
+
+    friend Type operator*(Type a, const double b)
+    {
+        return a *= b;
+    }
+
+    friend Type operator*(const double a, Type b)
+    {
+        return b *= a;
+    }
+
+    friend Type operator*(const Type& a, const Type& b)
+    {
+        Type result;
+
+        result.m_f = a.m_f * b.m_f;
+        result.m_g = a.m_g.colwise() * b.m_f + b.m_g.colwise() * a.m_f;
+
+        if constexpr (TOrder > 1) {
+            index k = 0;
+
+            for (index i = 0; i < TSize; i++) {
+                for (index j = i; j < TSize; j++, k++) {
+                    result.m_h.col(k) = a.m_h.col(k) * b.m_f + b.m_h.col(k) * a.m_f + a.m_g.col(i) * b.m_g.col(j) + a.m_g.col(j) * b.m_g.col(i);
+                }
+            }
+        }
+
+        return result;
+    }
+
+    friend Type sqrt(const Type& a)
+    {
+        const Lanes f = a.m_f.sqrt();
+        const Lanes d1 = 0.5 / f;
+        const Lanes d2 = -0.5 * d1 / a.m_f;
+
+        return apply(a, f, d1, d2);
+    }
+
+    friend Type reciprocal(const Type& a)
+    {
+        const Lanes f = a.m_f.inverse();
+        const Lanes d1 = -f * f;
+        const Lanes d2 = -2 * d1 * f;
+
+        return apply(a, f, d1, d2);
+    }
+
+    // vectors of three components
+
+    friend Type dot(const Vector3& a, const Vector3& b)
+    {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    friend Vector3 cross(const Vector3& a, const Vector3& b)
+    {
+        return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+    }
+
+    friend Vector3 normalized(const Vector3& a)
+    {
+        const Type inv_norm = reciprocal(sqrt(dot(a, a)));
+
+        return {a[0] * inv_norm, a[1] * inv_norm, a[2] * inv_norm};
+    }
+}; // class BatchedJet
+
+} // namespace eqlib
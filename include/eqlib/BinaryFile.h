@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Define.h"
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace eqlib {
+
+namespace binary_file {
+
+// every value and array is padded to a multiple of 8 bytes, so the data of
+// each array is aligned within the file and can be used in place when the
+// file is mapped into memory
+
+constexpr std::streamsize alignment = 8;
+
+inline void write_padding(std::ostream& stream, const std::streamsize size)
+{
+    const char zeros[alignment] = {};
+
+    stream.write(zeros, (alignment - size % alignment) % alignment);
+}
+
+inline void read_padding(std::istream& stream, const std::streamsize size)
+{
+    stream.ignore((alignment - size % alignment) % alignment);
+}
+
+inline void check(const std::istream& stream)
+{
+    if (!stream) {
+        throw std::runtime_error("Unexpected end of file");
+    }
+}
+
+template <typename T>
+void write(std::ostream& stream, const T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+
+    write_padding(stream, sizeof(T));
+}
+
+template <typename T>
+void write(std::ostream& stream, const std::vector<T>& values)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    const std::streamsize size = values.size() * sizeof(T);
+
+    write(stream, static_cast<std::int64_t>(values.size()));
+
+    stream.write(reinterpret_cast<const char*>(values.data()), size);
+
+    write_padding(stream, size);
+}
+
+template <typename T>
+void read(std::istream& stream, T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+
+    read_padding(stream, sizeof(T));
+
+    check(stream);
+}
+
+template <typename T>
+void read(std::istream& stream, std::vector<T>& values)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    std::int64_t nb_values;
+
+    read(stream, nb_values);
+
+    if (nb_values < 0) {
+        throw std::runtime_error("Invalid array size");
+    }
+
+    values.resize(nb_values);
+
+    const std::streamsize size = nb_values * sizeof(T);
+
+    stream.read(reinterpret_cast<char*>(values.data()), size);
+
+    read_padding(stream, size);
+
+    check(stream);
+}
+
+} // namespace binary_file
+
+} // namespace eqlib
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "Constraint.h"
+#include "Define.h"
+#include "Equation.h"
+#include "Variable.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace eqlib {
+
+/*
+* A constraint computed by a compiled function, e.g. from numba.cfunc or
+* ctypes, with the signature
+*
+*     void compute(const double* x, index n, index m, double* fs, double* gs, double* hs, void* data)
+*
+* fs has m entries, gs is a row-major m x n matrix and hs stores m row-major
+* n x n matrices one after another. gs and hs are null if they are not
+* requested. The function is called directly from the assembly, so it must
+* not touch the GIL. The caller keeps the function and
+* the data alive.
+*/
+class CFunctionConstraint : public Constraint {
+private: // types
+    using Type = CFunctionConstraint;
+    using ComputeFunction = void (*)(const double*, index, index, double*, double*, double*, void*);
+
+private: // variables
+    ComputeFunction m_compute;
+    void* m_data;
+
+public: // constructors
+    CFunctionConstraint(
+        const std::vector<Pointer<Equation>>& equations,
+        const std::vector<Pointer<Variable>>& variables,
+        ComputeFunction compute,
+        void* data)
+        : Constraint{}
+        , m_compute{compute}
+        , m_data{data}
+    {
+        if (compute == nullptr) {
+            throw std::invalid_argument("The function address is null");
+        }
+
+        m_equations = equations;
+        m_variables = variables;
+    }
+
+    CFunctionConstraint(
+        const std::vector<Pointer<Equation>>& equations,
+        const std::vector<Pointer<Variable>>& variables,
+        const std::uintptr_t compute,
+        const std::uintptr_t data)
+        : CFunctionConstraint(equations, variables, reinterpret_cast<ComputeFunction>(compute), reinterpret_cast<void*>(data))
+    {
+    }
+
+private: // methods
+    // true if the blocks follow each other in memory like in the buffer of
+    // the problem
+
+    template <typename TBlocks>
+    static bool is_contiguous(const TBlocks& blocks, const index size)
+    {
+        for (index k = 0; k < length(blocks); k++) {
+            if (blocks[k].size() != size || blocks[k].data() != blocks[0].data() + k * size) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+public: // methods
+    void compute(Ref<Vector> fs, const std::vector<Ref<Vector>>& gs, const std::vector<Ref<Matrix>>& hs) const override
+    {
+        const index m = nb_equations();
+        const index n = nb_variables();
+
+        if (m == 0) {
+            return;
+        }
+
+        // the buffers are allocated once per thread
+
+        thread_local Vector x;
+        thread_local Vector local_gs;
+        thread_local Vector local_hs;
+
+        x.resize(n);
+
+        for (index i = 0; i < n; i++) {
+            x(i) = m_variables[i]->value();
+        }
+
+        // empty blocks are not requested
+
+        const bool has_g = gs[0].size() != 0;
+        const bool has_h = has_g && hs[0].size() != 0;
+
+        const bool direct_g = !has_g || is_contiguous(gs, n);
+        const bool direct_h = !has_h || (is_contiguous(hs, n * n) && hs[0].outerStride() == n);
+
+        if (direct_g && direct_h) {
+            Ref<Vector> g = gs[0];
+            Ref<Matrix> h = hs[0];
+
+            m_compute(x.data(), n, m, fs.data(), has_g ? g.data() : nullptr, has_h ? h.data() : nullptr, m_data);
+            return;
+        }
+
+        local_gs.resize(m * n);
+        local_hs.resize(has_h ? m * n * n : 0);
+
+        m_compute(x.data(), n, m, fs.data(), local_gs.data(), has_h ? local_hs.data() : nullptr, m_data);
+
+        for (index k = 0; k < m; k++) {
+            Ref<Vector> g = gs[k];
+            g = local_gs.segment(k * n, n);
+
+            if (has_h) {
+                Ref<Matrix> h = hs[k];
+                h = Map<const Matrix>(local_hs.data() + k * n * n, n, n);
+            }
+        }
+    }
+
+public: // python
+    template <typename TModule>
+    static void register_python(TModule& m)
+    {
+        namespace py = pybind11;
+        using namespace pybind11::literals;
+
+        using Base = Constraint;
+        using Holder = Pointer<Type>;
+
+        py::class_<Type, Base, Holder>(m, "CFunctionConstraint")
+            // constructors
+            .def(py::init<const std::vector<Pointer<Equation>>&, const std::vector<Pointer<Variable>>&, std::uintptr_t, std::uintptr_t>(), "equations"_a, "variables"_a, "address"_a, "data"_a = 0);
+    }
+};
+
+} // namespace eqlib
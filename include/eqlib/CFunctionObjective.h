@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Define.h"
+#include "Objective.h"
+#include "Variable.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace eqlib {
+
+/*
+* An objective computed by a compiled function, e.g. from numba.cfunc or
+* ctypes, with the signature
+*
+*     double compute(const double* x, index n, double* g, double* h, void* data)
+*
+* g has n entries and h is a row-major n x n matrix. They are null if they
+* are not requested. The function is called directly from the assembly, so it
+* must not touch the GIL. The caller keeps the function and the data alive.
+*/
+class CFunctionObjective : public Objective {
+private: // types
+    using Type = CFunctionObjective;
+    using ComputeFunction = double (*)(const double*, index, double*, double*, void*);
+
+private: // variables
+    ComputeFunction m_compute;
+    void* m_data;
+
+public: // constructors
+    CFunctionObjective(
+        const std::vector<Pointer<Variable>>& variables,
+        ComputeFunction compute,
+        void* data)
+        : Objective{}
+        , m_compute{compute}
+        , m_data{data}
+    {
+        if (compute == nullptr) {
+            throw std::invalid_argument("The function address is null");
+        }
+
+        m_variables = variables;
+    }
+
+    CFunctionObjective(
+        const std::vector<Pointer<Variable>>& variables,
+        const std::uintptr_t compute,
+        const std::uintptr_t data)
+        : CFunctionObjective(variables, reinterpret_cast<ComputeFunction>(compute), reinterpret_cast<void*>(data))
+    {
+    }
+
+public: // methods
+    double compute(Ref<Vector> g, Ref<Matrix> h) const override
+    {
+        const index n = nb_variables();
+
+        // the buffers are allocated once per thread
+
+        thread_local Vector x;
+        thread_local Matrix local_h;
+
+        x.resize(n);
+
+        for (index i = 0; i < n; i++) {
+            x(i) = m_variables[i]->value();
+        }
+
+        double* g_data = g.size() == 0 ? nullptr : g.data();
+
+        if (h.size() == 0) {
+            return m_compute(x.data(), n, g_data, nullptr, m_data);
+        }
+
+        if (h.outerStride() == n) {
+            return m_compute(x.data(), n, g_data, h.data(), m_data);
+        }
+
+        local_h.resize(n, n);
+
+        const double f = m_compute(x.data(), n, g_data, local_h.data(), m_data);
+
+        h = local_h;
+
+        return f;
+    }
+
+public: // python
+    template <typename TModule>
+    static void register_python(TModule& m)
+    {
+        namespace py = pybind11;
+        using namespace pybind11::literals;
+
+        using Base = Objective;
+        using Holder = Pointer<Type>;
+
+        py::class_<Type, Base, Holder>(m, "CFunctionObjective")
+            // constructors
+            .def(py::init<const std::vector<Pointer<Variable>>&, std::uintptr_t, std::uintptr_t>(), "variables"_a, "address"_a, "data"_a = 0);
+    }
+};
+
+} // namespace eqlib
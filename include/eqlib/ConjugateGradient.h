@@ -0,0 +1,651 @@
+#pragma once
+
+#include "Define.h"
+#include "Log.h"
+#include "Problem.h"
+#include "Settings.h"
+#include "Telemetry.h"
+#include "Timer.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace eqlib {
+
+/*
+* Nonlinear conjugate gradient method with a strong Wolfe line search.
+*
+* Supported update formulas are Fletcher-Reeves, Polak-Ribiere+ and
+* Hager-Zhang. The search direction is reset to the steepest descent
+* direction every `restart` iterations (6 n by default), if consecutive
+* gradients are far from orthogonal (Powell) or if the direction is not a
+* descent direction.
+*
+* With preconditioning enabled the diagonal of the hessian (plus damping) is
+* used as a diagonal preconditioner. It is updated at every restart.
+*/
+class ConjugateGradient {
+private: // types
+    using Type = eqlib::ConjugateGradient;
+
+    enum class Method {
+        FletcherReeves,
+        PolakRibiere,
+        HagerZhang
+    };
+
+private: // members
+    Pointer<Problem> m_problem;
+    Method m_method;
+    index m_iterations;
+    index m_maxiter;
+    index m_restart;
+    index m_nb_restarts;
+    index m_fevals;
+    index m_gevals;
+    index m_hevals;
+    double m_rnorm;
+    double m_rtol;
+    double m_xtol;
+    double m_damping;
+    double m_c1;
+    double m_c2;
+    index m_linesearch_maxiter;
+    bool m_preconditioning;
+    index m_stopping_reason;
+    Pointer<Telemetry> m_telemetry;
+
+    Vector m_x;
+    Vector m_x_trial;
+    Vector m_g;
+    Vector m_g_prev;
+    Vector m_pg;
+    Vector m_pg_prev;
+    Vector m_d;
+    Vector m_y;
+    Vector m_preconditioner;
+
+private: // constants
+    static constexpr double s_powell = 0.2;
+    static constexpr double s_hager_zhang_eta = 0.01;
+    static constexpr double s_refine = 1e-3;
+
+private: // methods: preconditioner
+    void update_preconditioner()
+    {
+        if (!m_preconditioning) {
+            m_preconditioner.setOnes();
+            return;
+        }
+
+        m_problem->compute<false, 2>();
+        m_fevals += 1;
+        m_gevals += 1;
+        m_hevals += 1;
+
+        m_preconditioner = m_problem->hm_diagonal();
+
+        for (index i = 0; i < length(m_preconditioner); i++) {
+            const double value = m_preconditioner(i) + m_damping;
+            m_preconditioner(i) = value > 0.0 ? 1.0 / value : 1.0;
+        }
+    }
+
+private: // methods: line search
+    void evaluate(const double alpha, double& f, double& dphi)
+    {
+        m_x_trial = m_x + alpha * m_d;
+        m_problem->set_x(m_x_trial);
+
+        m_problem->compute<false, 1>();
+        m_fevals += 1;
+        m_gevals += 1;
+
+        f = m_problem->f();
+        dphi = m_problem->df().dot(m_d);
+    }
+
+    static double interpolate(const double a, const double f_a, const double dphi_a, const double b, const double f_b, const double dphi_b)
+    {
+        // minimizer of the cubic interpolant, safeguarded by bisection
+
+        const double d1 = dphi_a + dphi_b - 3.0 * (f_a - f_b) / (a - b);
+        const double d2_squared = d1 * d1 - dphi_a * dphi_b;
+
+        const double lo = std::min(a, b);
+        const double hi = std::max(a, b);
+        const double margin = 0.1 * (hi - lo);
+
+        if (d2_squared >= 0.0) {
+            const double d2 = std::copysign(std::sqrt(d2_squared), b - a);
+            const double alpha = b - (b - a) * (dphi_b + d2 - d1) / (dphi_b - dphi_a + 2.0 * d2);
+
+            if (std::isfinite(alpha)) {
+                return std::clamp(alpha, lo + margin, hi - margin);
+            }
+        }
+
+        return 0.5 * (a + b);
+    }
+
+    // returns the accepted step length or -1. The problem holds the state at
+    // the accepted step length
+
+    double zoom(double lo, double f_lo, double dphi_lo, double hi, double f_hi, double dphi_hi, const double f_0, const double dphi_0)
+    {
+        for (index j = 0; j < m_linesearch_maxiter; j++) {
+            const double alpha = interpolate(lo, f_lo, dphi_lo, hi, f_hi, dphi_hi);
+
+            double f;
+            double dphi;
+
+            evaluate(alpha, f, dphi);
+
+            if (f > f_0 + m_c1 * alpha * dphi_0 || f >= f_lo) {
+                hi = alpha;
+                f_hi = f;
+                dphi_hi = dphi;
+            } else {
+                if (std::abs(dphi) <= -m_c2 * dphi_0) {
+                    return alpha;
+                }
+
+                if (dphi * (hi - lo) >= 0.0) {
+                    hi = lo;
+                    f_hi = f_lo;
+                    dphi_hi = dphi_lo;
+                }
+
+                lo = alpha;
+                f_lo = f;
+                dphi_lo = dphi;
+            }
+
+            if (std::abs(hi - lo) <= 1e-16 * std::max(1.0, std::abs(lo))) {
+                break;
+            }
+        }
+
+        // fall back to the best point with sufficient decrease
+
+        if (lo > 0.0) {
+            double f;
+            double dphi;
+            evaluate(lo, f, dphi);
+            return lo;
+        }
+
+        return -1.0;
+    }
+
+    // the initial step length is only a guess. A secant step improves an
+    // accepted first trial, which is exact for quadratic functions and keeps
+    // the search directions conjugate
+
+    double refine(const double alpha, const double f, const double dphi, const double f_0, const double dphi_0)
+    {
+        if (dphi <= dphi_0 || std::abs(dphi) <= s_refine * -dphi_0) {
+            return alpha;
+        }
+
+        const double alpha_secant = alpha * dphi_0 / (dphi_0 - dphi);
+
+        if (!(alpha_secant > 0.0 && alpha_secant < 4.0 * alpha)) {
+            return alpha;
+        }
+
+        double f_secant;
+        double dphi_secant;
+
+        evaluate(alpha_secant, f_secant, dphi_secant);
+
+        if (f_secant <= f && f_secant <= f_0 + m_c1 * alpha_secant * dphi_0 && std::abs(dphi_secant) <= -m_c2 * dphi_0) {
+            return alpha_secant;
+        }
+
+        double f_alpha;
+        double dphi_alpha;
+
+        evaluate(alpha, f_alpha, dphi_alpha);
+
+        return alpha;
+    }
+
+    double line_search(const double alpha_init, const double f_0, const double dphi_0)
+    {
+        double alpha_prev = 0.0;
+        double f_prev = f_0;
+        double dphi_prev = dphi_0;
+
+        double alpha = alpha_init;
+
+        for (index i = 0; i < m_linesearch_maxiter; i++) {
+            double f;
+            double dphi;
+
+            evaluate(alpha, f, dphi);
+
+            if (!std::isfinite(f)) {
+                alpha = 0.5 * (alpha_prev + alpha);
+                continue;
+            }
+
+            if (f > f_0 + m_c1 * alpha * dphi_0 || (i > 0 && f >= f_prev)) {
+                return zoom(alpha_prev, f_prev, dphi_prev, alpha, f, dphi, f_0, dphi_0);
+            }
+
+            if (std::abs(dphi) <= -m_c2 * dphi_0) {
+                if (i == 0) {
+                    return refine(alpha, f, dphi, f_0, dphi_0);
+                }
+
+                return alpha;
+            }
+
+            if (dphi >= 0.0) {
+                return zoom(alpha, f, dphi, alpha_prev, f_prev, dphi_prev, f_0, dphi_0);
+            }
+
+            alpha_prev = alpha;
+            f_prev = f;
+            dphi_prev = dphi;
+
+            alpha *= 2.0;
+        }
+
+        return -1.0;
+    }
+
+private: // methods: update
+    double beta() const
+    {
+        // m_y = g - g_prev
+
+        const double g_pg_prev = m_g_prev.dot(m_pg_prev);
+
+        switch (m_method) {
+        case Method::FletcherReeves:
+            return m_g.dot(m_pg) / g_pg_prev;
+        case Method::PolakRibiere:
+            return std::max(0.0, m_pg.dot(m_y) / g_pg_prev);
+        case Method::HagerZhang: {
+            const double dy = m_d.dot(m_y);
+            const double y_py = m_y.dot(m_y.cwiseProduct(m_preconditioner));
+            const double beta = (m_pg.dot(m_y) - 2.0 * y_py / dy * m_d.dot(m_g)) / dy;
+            const double eta = -1.0 / (m_d.norm() * std::min(s_hager_zhang_eta, m_g_prev.norm()));
+            return std::max(beta, eta);
+        }
+        }
+
+        return 0.0;
+    }
+
+public: // constructor
+    ConjugateGradient(Pointer<Problem> problem)
+        : m_problem(problem)
+        , m_method(Method::PolakRibiere)
+        , m_iterations(0)
+        , m_maxiter(100)
+        , m_restart(0)
+        , m_nb_restarts(0)
+        , m_fevals(0)
+        , m_gevals(0)
+        , m_hevals(0)
+        , m_rnorm(0.0)
+        , m_rtol(1e-6)
+        , m_xtol(1e-6)
+        , m_damping(0.0)
+        , m_c1(1e-4)
+        , m_c2(0.1)
+        , m_linesearch_maxiter(30)
+        , m_preconditioning(false)
+        , m_stopping_reason(-1)
+        , m_telemetry(new_<Telemetry>())
+    {
+        if (problem->is_constrained()) {
+            throw std::runtime_error("Constraints are not supported");
+        }
+    }
+
+public: // methods
+    index iterations() const noexcept
+    {
+        return m_iterations;
+    }
+
+    index nb_restarts() const noexcept
+    {
+        return m_nb_restarts;
+    }
+
+    index fevals() const noexcept
+    {
+        return m_fevals;
+    }
+
+    index gevals() const noexcept
+    {
+        return m_gevals;
+    }
+
+    index hevals() const noexcept
+    {
+        return m_hevals;
+    }
+
+    index maxiter() const noexcept
+    {
+        return m_maxiter;
+    }
+
+    void set_maxiter(const index value) noexcept
+    {
+        m_maxiter = value;
+    }
+
+    std::string method() const
+    {
+        switch (m_method) {
+        case Method::FletcherReeves:
+            return "fletcher_reeves";
+        case Method::PolakRibiere:
+            return "polak_ribiere";
+        case Method::HagerZhang:
+            return "hager_zhang";
+        }
+
+        return "";
+    }
+
+    void set_method(const std::string& value)
+    {
+        if (value == "fletcher_reeves") {
+            m_method = Method::FletcherReeves;
+        } else if (value == "polak_ribiere") {
+            m_method = Method::PolakRibiere;
+        } else if (value == "hager_zhang") {
+            m_method = Method::HagerZhang;
+        } else {
+            throw std::invalid_argument("Unknown method '" + value + "'");
+        }
+    }
+
+    index restart() const noexcept
+    {
+        return m_restart;
+    }
+
+    void set_restart(const index value) noexcept
+    {
+        m_restart = value;
+    }
+
+    bool preconditioning() const noexcept
+    {
+        return m_preconditioning;
+    }
+
+    void set_preconditioning(const bool value) noexcept
+    {
+        m_preconditioning = value;
+    }
+
+    double rnorm() const noexcept
+    {
+        return m_rnorm;
+    }
+
+    double rtol() const noexcept
+    {
+        return m_rtol;
+    }
+
+    void set_rtol(const double value) noexcept
+    {
+        m_rtol = value;
+    }
+
+    double xtol() const noexcept
+    {
+        return m_xtol;
+    }
+
+    void set_xtol(const double value) noexcept
+    {
+        m_xtol = value;
+    }
+
+    double damping() const noexcept
+    {
+        return m_damping;
+    }
+
+    void set_damping(const double value) noexcept
+    {
+        m_damping = value;
+    }
+
+    index stopping_reason() const noexcept
+    {
+        return m_stopping_reason;
+    }
+
+    Pointer<Telemetry> telemetry() const noexcept
+    {
+        return m_telemetry;
+    }
+
+    void run()
+    {
+        // setup
+
+        Log::task_begin("Solving nonlinear system using Conjugate Gradient ({})...", method());
+
+        Timer timer;
+
+        const index n = m_problem->nb_variables();
+
+        const index restart = m_restart > 0 ? m_restart : std::max(6 * n, index(1));
+
+        m_iterations = 0;
+        m_nb_restarts = 0;
+        m_fevals = 0;
+        m_gevals = 0;
+        m_hevals = 0;
+
+        m_x = m_problem->x();
+        m_x_trial.resize(n);
+        m_g.resize(n);
+        m_g_prev.resize(n);
+        m_pg.resize(n);
+        m_pg_prev.resize(n);
+        m_d.resize(n);
+        m_y.resize(n);
+        m_preconditioner.resize(n);
+
+        m_telemetry->begin(m_maxiter + 1);
+
+        update_preconditioner();
+
+        m_problem->compute<false, 1>();
+        m_fevals += 1;
+        m_gevals += 1;
+
+        m_g = m_problem->df();
+        m_pg = m_g.cwiseProduct(m_preconditioner);
+        m_d = -m_pg;
+
+        index iterations_since_restart = 0;
+        double alpha = -1.0;
+        double dphi_prev = 0.0;
+
+        for (index iteration = 0;; iteration++) {
+            Trace::Span iteration_span("ConjugateGradient iteration");
+
+            m_iterations = iteration;
+
+            // check residual norm
+
+            m_rnorm = m_g.norm();
+
+            Log::task_info("Iteration {}: f = {}, rnorm = {}", iteration + 1, m_problem->f(), m_rnorm);
+
+            if (m_rnorm < m_rtol) {
+                m_telemetry->record(m_problem->f(), m_rnorm, NAN, NAN, 0.0, 0.0, 0.0);
+                m_stopping_reason = 0;
+                Log::task_info("Stopped because rnorm < {}", m_rtol);
+                break;
+            }
+
+            // check max iterations
+
+            if (iteration >= m_maxiter) {
+                m_telemetry->record(m_problem->f(), m_rnorm, NAN, NAN, 0.0, 0.0, 0.0);
+                m_stopping_reason = 2;
+                Log::warn(1, "Stopped because iteration >= {}", m_maxiter);
+                break;
+            }
+
+            // ensure a descent direction
+
+            double dphi = m_g.dot(m_d);
+
+            bool is_restart = iterations_since_restart == 0;
+
+            if (dphi >= 0.0 && !is_restart) {
+                Log::task_info("Restart because the direction is not a descent direction");
+                m_d = -m_pg;
+                dphi = m_g.dot(m_d);
+                is_restart = true;
+                iterations_since_restart = 0;
+                m_nb_restarts += 1;
+            }
+
+            // line search
+
+            double alpha_init;
+
+            if (alpha < 0.0) {
+                alpha_init = std::min(1.0, 1.0 / m_d.lpNorm<Eigen::Infinity>());
+            } else {
+                alpha_init = alpha * dphi_prev / dphi;
+            }
+
+            const double f_0 = m_problem->f();
+
+            Timer step_timer;
+
+            alpha = line_search(alpha_init, f_0, dphi);
+
+            const double compute_time = step_timer.ellapsed();
+
+            if (alpha < 0.0) {
+                m_telemetry->record(f_0, m_rnorm, 0.0, NAN, compute_time, 0.0, 0.0);
+
+                m_problem->set_x(m_x);
+                m_problem->compute<false, 1>();
+                m_fevals += 1;
+                m_gevals += 1;
+
+                if (is_restart) {
+                    m_stopping_reason = 3;
+                    Log::warn(1, "Stopped because the line search failed");
+                    break;
+                }
+
+                Log::task_info("Restart because the line search failed");
+
+                update_preconditioner();
+                m_pg = m_g.cwiseProduct(m_preconditioner);
+                m_d = -m_pg;
+                iterations_since_restart = 0;
+                m_nb_restarts += 1;
+                continue;
+            }
+
+            dphi_prev = dphi;
+
+            m_x = m_x_trial;
+
+            // check x norm
+
+            const double xnorm = alpha * m_d.norm();
+
+            m_telemetry->record(f_0, m_rnorm, xnorm, alpha, compute_time, 0.0, 0.0);
+
+            if (xnorm < m_xtol) {
+                m_iterations = iteration + 1;
+                m_rnorm = m_problem->df().norm();
+                m_stopping_reason = 1;
+                Log::task_info("Stopped because xnorm < {}", m_xtol);
+                break;
+            }
+
+            // update search direction
+
+            m_g_prev = m_g;
+            m_pg_prev = m_pg;
+            m_g = m_problem->df();
+
+            iterations_since_restart += 1;
+
+            const bool powell = m_method != Method::HagerZhang && std::abs(m_g.dot(m_g_prev)) >= s_powell * m_g.dot(m_g);
+
+            if (iterations_since_restart >= restart || powell) {
+                if (m_preconditioning && m_g.norm() >= m_rtol) {
+                    update_preconditioner();
+                }
+
+                m_pg = m_g.cwiseProduct(m_preconditioner);
+                m_d = -m_pg;
+                iterations_since_restart = 0;
+                m_nb_restarts += 1;
+                continue;
+            }
+
+            m_pg = m_g.cwiseProduct(m_preconditioner);
+            m_y = m_g - m_g_prev;
+
+            const double b = beta();
+
+            m_d = b * m_d - m_pg;
+        }
+
+        m_telemetry->end();
+
+        Log::task_end("System solved in {:.3f} sec", timer.ellapsed());
+    }
+
+public: // python
+    template <typename TModule>
+    static void register_python(TModule& m)
+    {
+        namespace py = pybind11;
+        using namespace pybind11::literals;
+
+        py::class_<Type>(m, "ConjugateGradient")
+            .def(py::init<Pointer<eqlib::Problem>>(), "problem"_a)
+            .def("run", &Type::run, py::call_guard<py::gil_scoped_release>())
+            // properties
+            .def_property("damping", &Type::damping, &Type::set_damping)
+            .def_property("maxiter", &Type::maxiter, &Type::set_maxiter)
+            .def_property("method", &Type::method, &Type::set_method)
+            .def_property("preconditioning", &Type::preconditioning, &Type::set_preconditioning)
+            .def_property("restart", &Type::restart, &Type::set_restart)
+            .def_property("rtol", &Type::rtol, &Type::set_rtol)
+            .def_property("xtol", &Type::xtol, &Type::set_xtol)
+            // read-only properties
+            .def_property_readonly("iterations", &Type::iterations)
+            .def_property_readonly("nb_restarts", &Type::nb_restarts)
+            .def_property_readonly("rnorm", &Type::rnorm)
+            .def_property_readonly("stopping_reason", &Type::stopping_reason)
+            .def_property_readonly("telemetry", &Type::telemetry)
+            .def_property_readonly("fevals", &Type::fevals)
+            .def_property_readonly("gevals", &Type::gevals)
+            .def_property_readonly("hevals", &Type::hevals);
+    }
+}; // class ConjugateGradient
+
+} // namespace eqlib
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "BinaryFile.h"
+#include "Define.h"
+
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace eqlib {
+
+/*
+* Local and global indices of the equations or variables of a list of
+* elements.
+*
+* The entries of element i are stored in one flat array between offset(i)
+* and offset(i + 1). Optionally, every entry carries a 32-bit offset into the
+* values of the hessian.
+*/
+class ElementIndices {
+public: // types
+    struct Entry {
+        std::int32_t local;
+        std::int32_t global;
+
+        Entry() = default;
+
+        Entry(index local, index global)
+            : local(static_cast<std::int32_t>(local))
+            , global(static_cast<std::int32_t>(global))
+        {
+        }
+
+        bool operator<(const Entry& other) const noexcept
+        {
+            return global < other.global;
+        }
+    };
+
+    class Range {
+    private: // variables
+        const Entry* m_begin;
+        index m_size;
+
+    public: // constructor
+        Range(const Entry* begin, const index size)
+            : m_begin(begin)
+            , m_size(size)
+        {
+        }
+
+    public: // methods
+        const Entry* begin() const noexcept
+        {
+            return m_begin;
+        }
+
+        const Entry* end() const noexcept
+        {
+            return m_begin + m_size;
+        }
+
+        index size() const noexcept
+        {
+            return m_size;
+        }
+
+        bool empty() const noexcept
+        {
+            return m_size == 0;
+        }
+
+        const Entry& operator[](const index i) const noexcept
+        {
+            return m_begin[i];
+        }
+
+        const Entry& back() const noexcept
+        {
+            return m_begin[m_size - 1];
+        }
+    };
+
+private: // variables
+    std::vector<index> m_offsets;
+    std::vector<Entry> m_entries;
+    std::vector<std::int32_t> m_hm_offsets;
+
+public: // constructor
+    ElementIndices()
+        : m_offsets(1, 0)
+    {
+    }
+
+public: // methods
+    static void check_range(const index value)
+    {
+        if (value > std::numeric_limits<std::int32_t>::max()) {
+            throw std::runtime_error("Index exceeds the 32-bit range of the element indices");
+        }
+    }
+
+    // allocates the entries for elements with the given number of entries
+
+    void allocate(const std::vector<index>& sizes)
+    {
+        m_offsets.resize(sizes.size() + 1);
+        m_offsets[0] = 0;
+
+        for (index i = 0; i < length(sizes); i++) {
+            m_offsets[i + 1] = m_offsets[i] + sizes[i];
+        }
+
+        m_entries.resize(m_offsets.back());
+        m_hm_offsets.clear();
+    }
+
+    void allocate_hm_offsets()
+    {
+        m_hm_offsets.resize(m_entries.size());
+    }
+
+    index nb_elements() const noexcept
+    {
+        return length(m_offsets) - 1;
+    }
+
+    index nb_entries() const noexcept
+    {
+        return length(m_entries);
+    }
+
+    bool has_hm_offsets() const noexcept
+    {
+        return !m_hm_offsets.empty();
+    }
+
+    index offset(const index i) const noexcept
+    {
+        return m_offsets[i];
+    }
+
+    index size(const index i) const noexcept
+    {
+        return m_offsets[i + 1] - m_offsets[i];
+    }
+
+    Range operator[](const index i) const noexcept
+    {
+        return Range(m_entries.data() + m_offsets[i], size(i));
+    }
+
+    Entry* entries(const index i) noexcept
+    {
+        return m_entries.data() + m_offsets[i];
+    }
+
+    std::int32_t* hm_offsets(const index i) noexcept
+    {
+        return m_hm_offsets.data() + m_offsets[i];
+    }
+
+    const std::int32_t* hm_offsets(const index i) const noexcept
+    {
+        return m_hm_offsets.data() + m_offsets[i];
+    }
+
+    // keeps only the elements with a nonzero mask in their original order
+
+    void compact(const std::vector<bool>& mask)
+    {
+        index j = 0;
+        index offset = 0;
+
+        for (index i = 0; i < nb_elements(); i++) {
+            if (!mask[i]) {
+                continue;
+            }
+
+            const index begin = m_offsets[i];
+            const index end = m_offsets[i + 1];
+
+            for (index k = begin; k < end; k++) {
+                m_entries[offset + k - begin] = m_entries[k];
+
+                if (has_hm_offsets()) {
+                    m_hm_offsets[offset + k - begin] = m_hm_offsets[k];
+                }
+            }
+
+            m_offsets[j] = offset;
+            offset += end - begin;
+            j += 1;
+        }
+
+        m_offsets[j] = offset;
+        m_offsets.resize(j + 1);
+        m_entries.resize(offset);
+
+        if (has_hm_offsets()) {
+            m_hm_offsets.resize(offset);
+        }
+    }
+
+    void write(std::ostream& stream) const
+    {
+        binary_file::write(stream, m_offsets);
+        binary_file::write(stream, m_entries);
+        binary_file::write(stream, m_hm_offsets);
+    }
+
+    void read(std::istream& stream)
+    {
+        binary_file::read(stream, m_offsets);
+        binary_file::read(stream, m_entries);
+        binary_file::read(stream, m_hm_offsets);
+
+        if (m_offsets.empty() || m_offsets.front() != 0 || m_offsets.back() != nb_entries() || (has_hm_offsets() && length(m_hm_offsets) != nb_entries())) {
+            throw std::runtime_error("Invalid element indices");
+        }
+    }
+
+    size_t memory_usage() const noexcept
+    {
+        return m_offsets.capacity() * sizeof(index) + m_entries.capacity() * sizeof(Entry) + m_hm_offsets.capacity() * sizeof(std::int32_t);
+    }
+
+    // memory of the same data stored as one vector of 64-bit pairs (and one
+    // vector of 64-bit hessian offsets) per element
+
+    size_t nested_memory_usage() const noexcept
+    {
+        const size_t nb_vectors = has_hm_offsets() ? 2 : 1;
+
+        size_t result = nb_vectors * (nb_elements() + 1) * sizeof(std::vector<index>);
+
+        result += m_entries.size() * 2 * sizeof(index);
+
+        if (has_hm_offsets()) {
+            result += m_entries.size() * sizeof(index);
+        }
+
+        return result;
+    }
+}; // class ElementIndices
+
+} // namespace eqlib
@@ -16,6 +16,8 @@ private: // variables
     bool m_is_active;
     double m_multiplier;
     std::string m_name;
+    size_t m_slot_problem;
+    index m_slot_index;
 
 public: // constructors
     Equation(const double lower_bound, const double upper_bound, const double multiplier, const std::string name) noexcept
@@ -24,6 +26,8 @@ public: // constructors
         , m_is_active(true)
         , m_multiplier(multiplier)
         , m_name(name)
+        , m_slot_problem(0)
+        , m_slot_index(-1)
     {
     }
 
@@ -32,6 +36,22 @@ public: // constructors
     {
     }
 
+    Equation(const Equation& other) noexcept
+        : Equation(other.lower_bound(), other.upper_bound(), other.multiplier(), other.name())
+    {
+        m_is_active = other.is_active();
+    }
+
+    Equation& operator=(const Equation& other) noexcept
+    {
+        set_lower_bound(other.lower_bound());
+        set_upper_bound(other.upper_bound());
+        set_active(other.is_active());
+        set_multiplier(other.multiplier());
+        set_name(other.name());
+        return *this;
+    }
+
 public: // methods
     bool is_active() const noexcept
     {
@@ -73,6 +93,25 @@ public: // methods
         m_multiplier = value;
     }
 
+    // the slot holds the index of the equation in the problem which was set up
+    // last with this equation
+
+    size_t slot_problem() const noexcept
+    {
+        return m_slot_problem;
+    }
+
+    index slot_index() const noexcept
+    {
+        return m_slot_index;
+    }
+
+    void set_slot(const size_t problem, const index index) noexcept
+    {
+        m_slot_problem = problem;
+        m_slot_index = index;
+    }
+
     const std::string& name() const noexcept
     {
         return m_name;
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Define.h"
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <type_traits>
+
+namespace eqlib {
+
+/*
+* Python handle of an asynchronous operation. The result is converted to a
+* Python object when it is requested, so the worker does not need the GIL.
+* Exceptions thrown by the worker are raised by result.
+*/
+class Future {
+private: // types
+    using Type = Future;
+
+private: // variables
+    std::function<bool()> m_done;
+    std::function<void()> m_wait;
+    std::function<pybind11::object()> m_result;
+
+public: // constructors
+    template <typename T>
+    Future(std::shared_future<T> future)
+        : m_done([=]() { return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; })
+        , m_wait([=]() { future.wait(); })
+        , m_result([=]() {
+            if constexpr (std::is_void_v<T>) {
+                future.get();
+                return pybind11::object(pybind11::none());
+            } else {
+                return pybind11::object(pybind11::cast(future.get()));
+            }
+        })
+    {
+    }
+
+public: // methods
+    bool done() const
+    {
+        return m_done();
+    }
+
+    void wait() const
+    {
+        m_wait();
+    }
+
+    pybind11::object result() const
+    {
+        return m_result();
+    }
+
+public: // python
+    template <typename TModule>
+    static void register_python(TModule& m)
+    {
+        namespace py = pybind11;
+        using namespace pybind11::literals;
+
+        using Holder = Pointer<Type>;
+
+        py::class_<Type, Holder>(m, "Future")
+            // methods
+            .def("done", &Type::done)
+            .def("wait", &Type::wait, py::call_guard<py::gil_scoped_release>())
+            .def("result", [](const Type& self) {
+                {
+                    py::gil_scoped_release release;
+                    self.wait();
+                }
+                return self.result();
+            })
+            .def("__await__", [](py::object self) {
+                // waits in the default executor of the running event loop
+
+                const auto loop = py::module::import("asyncio").attr("get_running_loop")();
+
+                return loop.attr("run_in_executor")(py::none(), self.attr("result")).attr("__await__")();
+            });
+    }
+};
+
+} // namespace eqlib
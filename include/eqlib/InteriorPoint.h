@@ -0,0 +1,936 @@
+#pragma once
+
+#include "Define.h"
+#include "LinearSolver.h"
+#include "Log.h"
+#ifdef EQLIB_USE_MKL
+#include "PardisoLDLT.h"
+#endif
+#include "Problem.h"
+#include "SimplicialLDLT.h"
+#include "SparseStructure.h"
+#include "Timer.h"
+#include "Trace.h"
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace eqlib {
+
+/*
+* Primal-dual interior point method with filter line search and inertia
+* correction following Wächter and Biegler: On the implementation of an
+* interior-point filter line-search algorithm for large-scale nonlinear
+* programming (2006).
+*
+* Inequality constraints are converted to equalities using slack variables.
+* For problems without constraints the barrier terms are added in place to the
+* diagonal of the hessian and the linear solver of the problem is used.
+*/
+class InteriorPoint {
+private: // types
+    using Type = eqlib::InteriorPoint;
+
+    using Filter = std::vector<std::pair<double, double>>;
+
+private: // members
+    Pointer<Problem> m_problem;
+    Pointer<LinearSolver> m_linear_solver;
+    index m_iterations;
+    index m_maxiter;
+    index m_fevals;
+    index m_gevals;
+    index m_hevals;
+    double m_rnorm;
+    double m_tol;
+    double m_mu_init;
+    double m_mu;
+    double m_delta_w_last;
+    index m_stopping_reason;
+
+    index m_n;
+    index m_m;
+    index m_nb_slacks;
+
+    std::vector<index> m_slack_equations;
+    std::vector<index> m_equation_slacks;
+
+    Vector m_lower;
+    Vector m_upper;
+    Vector m_equality_values;
+
+    SparseStructure<double, int, true> m_kkt_structure;
+    Vector m_kkt_values;
+    std::vector<index> m_kkt_hm_indices;
+    std::vector<index> m_kkt_dg_indices;
+    std::vector<index> m_kkt_slack_indices;
+    std::vector<index> m_kkt_diagonal_indices;
+
+    Vector m_w;
+    Vector m_w_trial;
+    Vector m_dw;
+    Vector m_lambda;
+    Vector m_dlambda;
+    Vector m_z_lower;
+    Vector m_z_upper;
+    Vector m_dz_lower;
+    Vector m_dz_upper;
+    Vector m_sigma;
+    Vector m_diagonal;
+    Vector m_c;
+    Vector m_c_trial;
+    Vector m_grad_f;
+    Vector m_grad_lagrange;
+    Vector m_rhs;
+    Vector m_solution;
+
+private: // constants
+    static constexpr double s_max = 100.0;
+    static constexpr double s_kappa_1 = 1e-2;
+    static constexpr double s_kappa_2 = 1e-2;
+    static constexpr double s_kappa_epsilon = 10.0;
+    static constexpr double s_kappa_mu = 0.2;
+    static constexpr double s_theta_mu = 1.5;
+    static constexpr double s_tau_min = 0.99;
+    static constexpr double s_kappa_sigma = 1e10;
+    static constexpr double s_gamma_theta = 1e-5;
+    static constexpr double s_gamma_phi = 1e-5;
+    static constexpr double s_gamma_alpha = 0.05;
+    static constexpr double s_delta = 1.0;
+    static constexpr double s_s_theta = 1.1;
+    static constexpr double s_s_phi = 2.3;
+    static constexpr double s_eta_phi = 1e-4;
+    static constexpr double s_delta_w_min = 1e-20;
+    static constexpr double s_delta_w_0 = 1e-4;
+    static constexpr double s_delta_w_max = 1e40;
+    static constexpr double s_kappa_w_minus = 1.0 / 3.0;
+    static constexpr double s_kappa_w_plus = 8.0;
+    static constexpr double s_kappa_w_plus_bar = 100.0;
+    static constexpr double s_delta_c_bar = 1e-8;
+    static constexpr double s_kappa_c = 0.25;
+
+public: // constructor
+    InteriorPoint(Pointer<Problem> problem)
+        : m_problem(problem)
+        , m_iterations(0)
+        , m_maxiter(3000)
+        , m_fevals(0)
+        , m_gevals(0)
+        , m_hevals(0)
+        , m_rnorm(0.0)
+        , m_tol(1e-8)
+        , m_mu_init(0.1)
+        , m_mu(0.1)
+        , m_delta_w_last(0.0)
+        , m_stopping_reason(-1)
+    {
+#ifdef EQLIB_USE_MKL
+        m_linear_solver = new_<PardisoLDLT>();
+#else
+        m_linear_solver = new_<SimplicialLDLT>();
+#endif
+    }
+
+private: // methods: setup
+    index nb_primal() const noexcept
+    {
+        return m_n + m_nb_slacks;
+    }
+
+    void initialize_layout()
+    {
+        m_n = m_problem->nb_variables();
+        m_m = m_problem->nb_equations();
+
+        m_slack_equations.clear();
+        m_equation_slacks.assign(m_m, -1);
+        m_equality_values = Vector::Zero(m_m);
+
+        for (index r = 0; r < m_m; r++) {
+            const auto& equation = m_problem->equation(r);
+
+            if (equation->lower_bound() == equation->upper_bound()) {
+                m_equality_values(r) = equation->lower_bound();
+            } else {
+                m_equation_slacks[r] = length(m_slack_equations);
+                m_slack_equations.push_back(r);
+            }
+        }
+
+        m_nb_slacks = length(m_slack_equations);
+
+        const index n = nb_primal();
+
+        m_lower.resize(n);
+        m_upper.resize(n);
+
+        for (index i = 0; i < m_n; i++) {
+            const auto& variable = m_problem->variable(i);
+            m_lower(i) = variable->lower_bound();
+            m_upper(i) = variable->upper_bound();
+        }
+
+        for (index k = 0; k < m_nb_slacks; k++) {
+            const auto& equation = m_problem->equation(m_slack_equations[k]);
+            m_lower(m_n + k) = equation->lower_bound();
+            m_upper(m_n + k) = equation->upper_bound();
+        }
+
+        for (index i = 0; i < n; i++) {
+            if (m_lower(i) > m_upper(i)) {
+                throw std::runtime_error("Inconsistent bounds");
+            }
+            if (m_lower(i) == m_upper(i)) {
+                throw std::runtime_error("Fixed variables are not supported");
+            }
+        }
+
+        m_w.resize(n);
+        m_w_trial.resize(n);
+        m_dw.resize(n);
+        m_z_lower.resize(n);
+        m_z_upper.resize(n);
+        m_dz_lower.resize(n);
+        m_dz_upper.resize(n);
+        m_sigma.resize(n);
+        m_diagonal.resize(n);
+        m_grad_f.resize(n);
+        m_grad_lagrange.resize(n);
+        m_lambda = Vector::Zero(m_m);
+        m_dlambda.resize(m_m);
+        m_c.resize(m_m);
+        m_c_trial.resize(m_m);
+        m_rhs.resize(n + m_m);
+        m_solution.resize(n + m_m);
+    }
+
+    void initialize_kkt()
+    {
+        const index n = nb_primal();
+
+        if (m_m == 0) {
+            const auto& ia = m_problem->hm_indptr();
+            const auto& ja = m_problem->hm_indices();
+
+            m_kkt_diagonal_indices.resize(n);
+
+            for (index i = 0; i < n; i++) {
+                if (ia[i] == ia[i + 1] || ja[ia[i]] != i) {
+                    throw std::runtime_error("The hessian has no diagonal entry");
+                }
+
+                m_kkt_diagonal_indices[i] = ia[i];
+            }
+
+            return;
+        }
+
+        const index size = n + m_m;
+
+        const auto& hm_ia = m_problem->hm_indptr();
+        const auto& hm_ja = m_problem->hm_indices();
+        const auto& dg_ia = m_problem->dg_indptr();
+        const auto& dg_ja = m_problem->dg_indices();
+
+        std::vector<std::vector<index>> pattern(size);
+
+        for (index i = 0; i < m_n; i++) {
+            if (hm_ia[i] == hm_ia[i + 1] || hm_ja[hm_ia[i]] != i) {
+                pattern[i].push_back(i);
+            }
+
+            for (index k = hm_ia[i]; k < hm_ia[i + 1]; k++) {
+                pattern[i].push_back(hm_ja[k]);
+            }
+        }
+
+        for (index r = 0; r < m_m; r++) {
+            for (index k = dg_ia[r]; k < dg_ia[r + 1]; k++) {
+                pattern[dg_ja[k]].push_back(n + r);
+            }
+        }
+
+        for (index k = 0; k < m_nb_slacks; k++) {
+            pattern[m_n + k] = {m_n + k, n + m_slack_equations[k]};
+        }
+
+        for (index r = 0; r < m_m; r++) {
+            pattern[n + r] = {n + r};
+        }
+
+        m_kkt_structure = SparseStructure<double, int, true>::from_pattern(size, size, pattern);
+
+        m_kkt_values = Vector::Zero(m_kkt_structure.nb_nonzeros());
+
+        m_kkt_hm_indices.resize(hm_ja.size());
+
+        for (index i = 0; i < m_n; i++) {
+            for (index k = hm_ia[i]; k < hm_ia[i + 1]; k++) {
+                m_kkt_hm_indices[k] = m_kkt_structure.get_index(i, hm_ja[k]);
+            }
+        }
+
+        m_kkt_dg_indices.resize(dg_ja.size());
+
+        for (index r = 0; r < m_m; r++) {
+            for (index k = dg_ia[r]; k < dg_ia[r + 1]; k++) {
+                m_kkt_dg_indices[k] = m_kkt_structure.get_index(dg_ja[k], n + r);
+            }
+        }
+
+        m_kkt_slack_indices.resize(m_nb_slacks);
+
+        for (index k = 0; k < m_nb_slacks; k++) {
+            m_kkt_slack_indices[k] = m_kkt_structure.get_index(m_n + k, n + m_slack_equations[k]);
+        }
+
+        m_kkt_diagonal_indices.resize(size);
+
+        for (index i = 0; i < size; i++) {
+            m_kkt_diagonal_indices[i] = m_kkt_structure.get_index(i, i);
+        }
+    }
+
+    void initialize_point()
+    {
+        const index n = nb_primal();
+
+        m_w.head(m_n) = m_problem->x();
+
+        if (m_nb_slacks > 0) {
+            m_problem->set_x(m_w.head(m_n));
+            m_problem->compute<false, 0>();
+            m_fevals += 1;
+
+            for (index k = 0; k < m_nb_slacks; k++) {
+                m_w(m_n + k) = m_problem->g(m_slack_equations[k]);
+            }
+        }
+
+        for (index i = 0; i < n; i++) {
+            const double lower = m_lower(i);
+            const double upper = m_upper(i);
+
+            const bool has_lower = std::isfinite(lower);
+            const bool has_upper = std::isfinite(upper);
+
+            double push_lower = s_kappa_1 * std::max(1.0, std::abs(lower));
+            double push_upper = s_kappa_1 * std::max(1.0, std::abs(upper));
+
+            if (has_lower && has_upper) {
+                push_lower = std::min(push_lower, s_kappa_2 * (upper - lower));
+                push_upper = std::min(push_upper, s_kappa_2 * (upper - lower));
+            }
+
+            if (has_lower) {
+                m_w(i) = std::max(m_w(i), lower + push_lower);
+            }
+
+            if (has_upper) {
+                m_w(i) = std::min(m_w(i), upper - push_upper);
+            }
+
+            m_z_lower(i) = has_lower ? 1.0 : 0.0;
+            m_z_upper(i) = has_upper ? 1.0 : 0.0;
+        }
+
+        m_lambda.setZero();
+    }
+
+private: // methods: evaluation
+    Ref<Vector> kkt_values()
+    {
+        if (m_m == 0) {
+            return m_problem->hm_values();
+        }
+
+        return m_kkt_values;
+    }
+
+    const std::vector<int>& kkt_ia() const
+    {
+        return m_m == 0 ? m_problem->hm_indptr() : m_kkt_structure.ia();
+    }
+
+    const std::vector<int>& kkt_ja() const
+    {
+        return m_m == 0 ? m_problem->hm_indices() : m_kkt_structure.ja();
+    }
+
+    LinearSolver& linear_solver()
+    {
+        return m_m == 0 ? *m_problem->linear_solver() : *m_linear_solver;
+    }
+
+    void compute_constraint_violation(Ref<const Vector> w, Ref<Vector> c) const
+    {
+        for (index r = 0; r < m_m; r++) {
+            const index k = m_equation_slacks[r];
+            c(r) = m_problem->g(r) - (k < 0 ? m_equality_values(r) : w(m_n + k));
+        }
+    }
+
+    double barrier_function(Ref<const Vector> w, const double f) const
+    {
+        double phi = f;
+
+        for (index i = 0; i < length(w); i++) {
+            if (std::isfinite(m_lower(i))) {
+                phi -= m_mu * std::log(w(i) - m_lower(i));
+            }
+            if (std::isfinite(m_upper(i))) {
+                phi -= m_mu * std::log(m_upper(i) - w(i));
+            }
+        }
+
+        return phi;
+    }
+
+    double optimality_error(const double mu) const
+    {
+        const index n = nb_primal();
+
+        double dual_infeasibility = 0.0;
+        double complementarity = 0.0;
+
+        for (index i = 0; i < n; i++) {
+            const double r = m_grad_lagrange(i) - m_z_lower(i) + m_z_upper(i);
+            dual_infeasibility = std::max(dual_infeasibility, std::abs(r));
+
+            if (std::isfinite(m_lower(i))) {
+                complementarity = std::max(complementarity, std::abs(m_z_lower(i) * (m_w(i) - m_lower(i)) - mu));
+            }
+
+            if (std::isfinite(m_upper(i))) {
+                complementarity = std::max(complementarity, std::abs(m_z_upper(i) * (m_upper(i) - m_w(i)) - mu));
+            }
+        }
+
+        const double z_norm = m_z_lower.lpNorm<1>() + m_z_upper.lpNorm<1>();
+
+        const double s_d = std::max(s_max, (m_lambda.lpNorm<1>() + z_norm) / std::max(index{1}, m_m + 2 * n)) / s_max;
+        const double s_c = std::max(s_max, z_norm / std::max(index{1}, 2 * n)) / s_max;
+
+        const double primal_infeasibility = m_m == 0 ? 0.0 : m_c.lpNorm<Eigen::Infinity>();
+
+        return std::max({dual_infeasibility / s_d, primal_infeasibility, complementarity / s_c});
+    }
+
+    void compute_system()
+    {
+        m_problem->set_x(m_w.head(m_n));
+        m_problem->set_equation_multipliers(m_lambda);
+        m_problem->compute<false, 2>();
+        m_gevals += 1;
+        m_hevals += 1;
+
+        m_grad_f.head(m_n) = m_problem->df();
+        m_grad_f.tail(m_nb_slacks).setZero();
+
+        m_grad_lagrange = m_grad_f;
+
+        if (m_m > 0) {
+            m_grad_lagrange.head(m_n) += m_lambda * m_problem->dg();
+
+            for (index k = 0; k < m_nb_slacks; k++) {
+                m_grad_lagrange(m_n + k) -= m_lambda(m_slack_equations[k]);
+            }
+
+            compute_constraint_violation(m_w, m_c);
+        }
+    }
+
+    void assemble_kkt()
+    {
+        const index n = nb_primal();
+
+        Ref<Vector> values = kkt_values();
+
+        if (m_m > 0) {
+            const auto hm = m_problem->hm_values();
+            const auto dg = m_problem->dg_values();
+
+            for (index k = 0; k < length(hm); k++) {
+                values(m_kkt_hm_indices[k]) = hm(k);
+            }
+
+            for (index k = 0; k < length(dg); k++) {
+                values(m_kkt_dg_indices[k]) = dg(k);
+            }
+
+            for (index k = 0; k < m_nb_slacks; k++) {
+                values(m_kkt_diagonal_indices[m_n + k]) = 0.0;
+                values(m_kkt_slack_indices[k]) = -1.0;
+            }
+        }
+
+        for (index i = 0; i < n; i++) {
+            m_diagonal(i) = values(m_kkt_diagonal_indices[i]);
+        }
+    }
+
+    void set_kkt_diagonal(const double delta_w, const double delta_c)
+    {
+        const index n = nb_primal();
+
+        Ref<Vector> values = kkt_values();
+
+        for (index i = 0; i < n; i++) {
+            values(m_kkt_diagonal_indices[i]) = m_diagonal(i) + m_sigma(i) + delta_w;
+        }
+
+        for (index r = 0; r < m_m; r++) {
+            values(m_kkt_diagonal_indices[n + r]) = -delta_c;
+        }
+    }
+
+    bool factorize_kkt()
+    {
+        double delta_w = 0.0;
+        double delta_c = 0.0;
+
+        while (true) {
+            set_kkt_diagonal(delta_w, delta_c);
+
+            Trace::Span span("factorize");
+
+            const bool is_singular = linear_solver().factorize(kkt_ia(), kkt_ja(), kkt_values());
+
+            span.end();
+
+            if (!is_singular) {
+                const index nb_negative = linear_solver().nb_negative_pivots();
+
+                if (nb_negative == -1 || nb_negative == m_m) {
+                    break;
+                }
+            } else if (m_m > 0 && delta_c == 0.0) {
+                delta_c = s_delta_c_bar * std::pow(m_mu, s_kappa_c);
+            }
+
+            if (delta_w == 0.0) {
+                if (m_delta_w_last == 0.0) {
+                    delta_w = s_delta_w_0;
+                } else {
+                    delta_w = std::max(s_delta_w_min, s_kappa_w_minus * m_delta_w_last);
+                }
+            } else if (m_delta_w_last == 0.0) {
+                delta_w *= s_kappa_w_plus_bar;
+            } else {
+                delta_w *= s_kappa_w_plus;
+            }
+
+            if (delta_w > s_delta_w_max) {
+                return true;
+            }
+
+            Log::task_info("Correcting the inertia with delta_w={} and delta_c={}", delta_w, delta_c);
+        }
+
+        if (delta_w != 0.0) {
+            m_delta_w_last = delta_w;
+        }
+
+        return false;
+    }
+
+    double fraction_to_boundary(Ref<const Vector> value, Ref<const Vector> delta, const double tau) const
+    {
+        double alpha = 1.0;
+
+        for (index i = 0; i < length(value); i++) {
+            if (delta(i) < 0.0) {
+                alpha = std::min(alpha, -tau * value(i) / delta(i));
+            }
+        }
+
+        return alpha;
+    }
+
+    double fraction_to_boundary_primal(const double tau) const
+    {
+        double alpha = 1.0;
+
+        for (index i = 0; i < nb_primal(); i++) {
+            if (std::isfinite(m_lower(i)) && m_dw(i) < 0.0) {
+                alpha = std::min(alpha, -tau * (m_w(i) - m_lower(i)) / m_dw(i));
+            }
+            if (std::isfinite(m_upper(i)) && m_dw(i) > 0.0) {
+                alpha = std::min(alpha, tau * (m_upper(i) - m_w(i)) / m_dw(i));
+            }
+        }
+
+        return alpha;
+    }
+
+public: // methods
+    index iterations() const noexcept
+    {
+        return m_iterations;
+    }
+
+    index fevals() const noexcept
+    {
+        return m_fevals;
+    }
+
+    index gevals() const noexcept
+    {
+        return m_gevals;
+    }
+
+    index hevals() const noexcept
+    {
+        return m_hevals;
+    }
+
+    index maxiter() const noexcept
+    {
+        return m_maxiter;
+    }
+
+    void set_maxiter(const index value) noexcept
+    {
+        m_maxiter = value;
+    }
+
+    double rnorm() const noexcept
+    {
+        return m_rnorm;
+    }
+
+    double tol() const noexcept
+    {
+        return m_tol;
+    }
+
+    void set_tol(const double value) noexcept
+    {
+        m_tol = value;
+    }
+
+    double mu_init() const noexcept
+    {
+        return m_mu_init;
+    }
+
+    void set_mu_init(const double value) noexcept
+    {
+        m_mu_init = value;
+    }
+
+    double mu() const noexcept
+    {
+        return m_mu;
+    }
+
+    index stopping_reason() const noexcept
+    {
+        return m_stopping_reason;
+    }
+
+    Vector z_lower() const
+    {
+        return m_z_lower.head(m_n);
+    }
+
+    Vector z_upper() const
+    {
+        return m_z_upper.head(m_n);
+    }
+
+    Pointer<LinearSolver> linear_solver() const noexcept
+    {
+        return m_linear_solver;
+    }
+
+    void set_linear_solver(const Pointer<LinearSolver> value)
+    {
+        if (value == nullptr) {
+            throw std::invalid_argument("Value is null");
+        }
+
+        m_linear_solver = value;
+    }
+
+    void run()
+    {
+        // setup
+
+        Log::task_begin("Solving nonlinear problem using the interior point method...");
+
+        Timer timer;
+
+        m_iterations = 0;
+        m_fevals = 0;
+        m_gevals = 0;
+        m_hevals = 0;
+        m_mu = m_mu_init;
+        m_delta_w_last = 0.0;
+
+        initialize_layout();
+
+        if (nb_primal() == 0) {
+            m_stopping_reason = 0;
+            Log::task_end("Problem has no variables");
+            return;
+        }
+
+        initialize_kkt();
+        initialize_point();
+
+        const index n = nb_primal();
+
+        Filter filter;
+
+        compute_system();
+
+        const double theta_init = m_m == 0 ? 0.0 : m_c.lpNorm<1>();
+        const double theta_max = 1e4 * std::max(1.0, theta_init);
+        const double theta_min = 1e-4 * std::max(1.0, theta_init);
+
+        filter.emplace_back(theta_max, -infinity);
+
+        for (index iteration = 0;; iteration++) {
+            Trace::Span iteration_span("InteriorPoint iteration");
+
+            // check convergence
+
+            m_rnorm = optimality_error(0.0);
+
+            Log::task_info("Iteration {}:", iteration + 1);
+            Log::task_info("The objective value is {}", m_problem->f());
+            Log::task_info("The optimality error is {}", m_rnorm);
+
+            if (m_rnorm <= m_tol) {
+                m_stopping_reason = 0;
+                Log::task_info("Stopped because the optimality error < {}", m_tol);
+                break;
+            }
+
+            if (iteration >= m_maxiter) {
+                m_stopping_reason = 2;
+                Log::warn(1, "Stopped because iteration >= {}", m_maxiter);
+                break;
+            }
+
+            m_iterations = iteration + 1;
+
+            // update barrier parameter
+
+            while (m_mu > m_tol / 10.0 && optimality_error(m_mu) <= s_kappa_epsilon * m_mu) {
+                m_mu = std::max(m_tol / 10.0, std::min(s_kappa_mu * m_mu, std::pow(m_mu, s_theta_mu)));
+
+                filter.clear();
+                filter.emplace_back(theta_max, -infinity);
+            }
+
+            Log::task_info("The barrier parameter is {}", m_mu);
+
+            const double tau = std::max(s_tau_min, 1.0 - m_mu);
+
+            // compute search direction
+
+            Log::task_step("Solving the KKT system with {}...", linear_solver().solver_name());
+
+            for (index i = 0; i < n; i++) {
+                double sigma = 0.0;
+                double barrier_gradient = 0.0;
+
+                if (std::isfinite(m_lower(i))) {
+                    sigma += m_z_lower(i) / (m_w(i) - m_lower(i));
+                    barrier_gradient -= m_mu / (m_w(i) - m_lower(i));
+                }
+
+                if (std::isfinite(m_upper(i))) {
+                    sigma += m_z_upper(i) / (m_upper(i) - m_w(i));
+                    barrier_gradient += m_mu / (m_upper(i) - m_w(i));
+                }
+
+                m_sigma(i) = sigma;
+                m_rhs(i) = -(m_grad_lagrange(i) + barrier_gradient);
+            }
+
+            m_rhs.tail(m_m) = -m_c;
+
+            assemble_kkt();
+
+            if (factorize_kkt()) {
+                m_stopping_reason = 3;
+                Log::warn(1, "Stopped because the inertia correction failed");
+                break;
+            }
+
+            Trace::Span solve_span("solve");
+
+            if (linear_solver().solve(kkt_ia(), kkt_ja(), kkt_values(), m_rhs, m_solution)) {
+                throw std::runtime_error("Solve failed");
+            }
+
+            solve_span.end();
+
+            m_dw = m_solution.head(n);
+            m_dlambda = m_solution.tail(m_m);
+
+            for (index i = 0; i < n; i++) {
+                m_dz_lower(i) = 0.0;
+                m_dz_upper(i) = 0.0;
+
+                if (std::isfinite(m_lower(i))) {
+                    const double d = m_w(i) - m_lower(i);
+                    m_dz_lower(i) = m_mu / d - m_z_lower(i) - m_z_lower(i) / d * m_dw(i);
+                }
+
+                if (std::isfinite(m_upper(i))) {
+                    const double d = m_upper(i) - m_w(i);
+                    m_dz_upper(i) = m_mu / d - m_z_upper(i) + m_z_upper(i) / d * m_dw(i);
+                }
+            }
+
+            const double alpha_max = fraction_to_boundary_primal(tau);
+            const double alpha_z = std::min(fraction_to_boundary(m_z_lower, m_dz_lower, tau), fraction_to_boundary(m_z_upper, m_dz_upper, tau));
+
+            // filter line search
+
+            Log::task_step("Performing the line search...");
+
+            const double f = m_problem->f();
+            const double theta = m_m == 0 ? 0.0 : m_c.lpNorm<1>();
+            const double phi = barrier_function(m_w, f);
+
+            double grad_phi_dw = m_grad_f.dot(m_dw);
+
+            for (index i = 0; i < n; i++) {
+                if (std::isfinite(m_lower(i))) {
+                    grad_phi_dw -= m_mu / (m_w(i) - m_lower(i)) * m_dw(i);
+                }
+                if (std::isfinite(m_upper(i))) {
+                    grad_phi_dw += m_mu / (m_upper(i) - m_w(i)) * m_dw(i);
+                }
+            }
+
+            double alpha_min = s_gamma_theta;
+
+            if (grad_phi_dw < 0.0) {
+                alpha_min = std::min(alpha_min, s_gamma_phi * theta / -grad_phi_dw);
+
+                if (theta <= theta_min) {
+                    alpha_min = std::min(alpha_min, s_delta * std::pow(theta, s_s_theta) / std::pow(-grad_phi_dw, s_s_phi));
+                }
+            }
+
+            alpha_min = std::max(s_gamma_alpha * alpha_min, std::numeric_limits<double>::epsilon());
+
+            double alpha = alpha_max;
+            bool is_accepted = false;
+            bool is_f_type = false;
+
+            while (alpha >= alpha_min) {
+                m_w_trial = m_w + alpha * m_dw;
+
+                m_problem->set_x(m_w_trial.head(m_n));
+                m_problem->compute<false, 0>();
+                m_fevals += 1;
+
+                compute_constraint_violation(m_w_trial, m_c_trial);
+
+                const double theta_trial = m_m == 0 ? 0.0 : m_c_trial.lpNorm<1>();
+                const double phi_trial = barrier_function(m_w_trial, m_problem->f());
+
+                bool is_acceptable = std::isfinite(phi_trial);
+
+                for (const auto& [filter_theta, filter_phi] : filter) {
+                    if (theta_trial >= filter_theta && phi_trial >= filter_phi) {
+                        is_acceptable = false;
+                        break;
+                    }
+                }
+
+                if (is_acceptable) {
+                    const bool switching = grad_phi_dw < 0.0 && alpha * std::pow(-grad_phi_dw, s_s_phi) > s_delta * std::pow(theta, s_s_theta);
+
+                    if (theta <= theta_min && switching) {
+                        is_f_type = true;
+                        is_accepted = phi_trial <= phi + s_eta_phi * alpha * grad_phi_dw;
+                    } else {
+                        is_f_type = false;
+                        is_accepted = theta_trial <= (1.0 - s_gamma_theta) * theta || phi_trial <= phi - s_gamma_phi * theta;
+                    }
+                }
+
+                if (is_accepted) {
+                    break;
+                }
+
+                alpha *= 0.5;
+            }
+
+            if (!is_accepted) {
+                m_problem->set_x(m_w.head(m_n));
+                m_stopping_reason = 4;
+                Log::warn(1, "Stopped because the line search failed");
+                break;
+            }
+
+            if (!is_f_type) {
+                filter.emplace_back((1.0 - s_gamma_theta) * theta, phi - s_gamma_phi * theta);
+            }
+
+            Log::task_info("The step length is {}", alpha);
+
+            // update iterates
+
+            m_w = m_w_trial;
+            m_lambda += alpha * m_dlambda;
+            m_z_lower += alpha_z * m_dz_lower;
+            m_z_upper += alpha_z * m_dz_upper;
+
+            for (index i = 0; i < n; i++) {
+                if (std::isfinite(m_lower(i))) {
+                    const double d = m_w(i) - m_lower(i);
+                    m_z_lower(i) = std::max(std::min(m_z_lower(i), s_kappa_sigma * m_mu / d), m_mu / (s_kappa_sigma * d));
+                }
+                if (std::isfinite(m_upper(i))) {
+                    const double d = m_upper(i) - m_w(i);
+                    m_z_upper(i) = std::max(std::min(m_z_upper(i), s_kappa_sigma * m_mu / d), m_mu / (s_kappa_sigma * d));
+                }
+            }
+
+            compute_system();
+        }
+
+        m_problem->set_equation_multipliers(m_lambda);
+
+        Log::task_end("Problem solved in {:.3f} sec", timer.ellapsed());
+    }
+
+public: // python
+    template <typename TModule>
+    static void register_python(TModule& m)
+    {
+        namespace py = pybind11;
+        using namespace pybind11::literals;
+
+        py::class_<Type>(m, "InteriorPoint")
+            .def(py::init<Pointer<eqlib::Problem>>(), "problem"_a)
+            .def("run", &Type::run, py::call_guard<py::gil_scoped_release>())
+            // properties
+            .def_property("linear_solver", &Type::linear_solver, &Type::set_linear_solver)
+            .def_property("maxiter", &Type::maxiter, &Type::set_maxiter)
+            .def_property("mu_init", &Type::mu_init, &Type::set_mu_init)
+            .def_property("tol", &Type::tol, &Type::set_tol)
+            // read-only properties
+            .def_property_readonly("iterations", &Type::iterations)
+            .def_property_readonly("mu", &Type::mu)
+            .def_property_readonly("rnorm", &Type::rnorm)
+            .def_property_readonly("stopping_reason", &Type::stopping_reason)
+            .def_property_readonly("z_lower", &Type::z_lower)
+            .def_property_readonly("z_upper", &Type::z_upper)
+            .def_property_readonly("fevals", &Type::fevals)
+            .def_property_readonly("gevals", &Type::gevals)
+            .def_property_readonly("hevals", &Type::hevals);
+    }
+}; // class InteriorPoint
+
+} // namespace eqlib
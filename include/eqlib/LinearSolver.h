@@ -38,7 +38,12 @@ public: // methods
     }
 
     virtual bool solve(const std::vector<int>& ia, const std::vector<int>& ja, Ref<const Vector> a, Ref<const Vector> b, Ref<Vector> x) = 0;
-    
+
+    virtual index nb_negative_pivots() const
+    {
+        return -1;
+    }
+
 public: // python
     template <typename T>
     class PyLinearSolver : public T {
@@ -63,6 +68,12 @@ public: // python
             pybind11::gil_scoped_acquire acquire;
             PYBIND11_OVERLOAD_PURE(bool, T, factorize, ia, ja, a, b, x);
         }
+
+        virtual index nb_negative_pivots() const override
+        {
+            pybind11::gil_scoped_acquire acquire;
+            PYBIND11_OVERLOAD(index, T, nb_negative_pivots);
+        }
     };
 
     template <typename TModule>
@@ -78,6 +89,7 @@ public: // python
             .def(py::init<>())
             // read-only properties
             .def_property("solver_name", &Type::solver_name, &Type::set_solver_name)
+            .def_property_readonly("nb_negative_pivots", &Type::nb_negative_pivots)
             // methods
             .def("analyze", &Type::analyze, "ia"_a, "ja"_a, "a"_a)
             .def("factorize", &Type::factorize, "ia"_a, "ja"_a, "a"_a)
@@ -0,0 +1,586 @@
+#pragma once
+
+#include "Define.h"
+#include "LinearSolver.h"
+#include "Log.h"
+#include "Parameter.h"
+#include "Problem.h"
+#include "Timer.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+namespace eqlib {
+
+/*
+* Load stepping with a tangent predictor and a Newton-Raphson corrector.
+*
+* The parameter is driven through the values of the schedule. Each schedule
+* value is reached by one or more load steps. The size of a load step adapts
+* to the number of corrector iterations of the previous step and is cut back
+* if the corrector fails.
+*
+* The predictor solves K dx = -df_dlambda dlambda with the factorization of
+* the last corrector iteration, so it costs one solve. The derivative of the
+* residual with respect to the parameter is either computed by a forward
+* finite difference or provided by the sensitivity callback.
+*
+* The linear solver of the problem is used for all factorizations, so the
+* symbolic analysis is done once for the whole run.
+*/
+class LoadStepping {
+private: // types
+    using Type = eqlib::LoadStepping;
+    using Sensitivity = std::function<Vector()>;
+    using IndexVector = Eigen::Matrix<index, 1, Eigen::Dynamic>;
+
+private: // members
+    Pointer<Problem> m_problem;
+    Pointer<Parameter> m_parameter;
+    std::vector<double> m_schedule;
+    Sensitivity m_sensitivity;
+    index m_maxiter;
+    index m_desired_iterations;
+    index m_max_cutbacks;
+    index m_fevals;
+    index m_gevals;
+    index m_hevals;
+    double m_rtol;
+    double m_xtol;
+    double m_initial_step;
+    double m_min_step;
+    double m_max_step;
+    double m_cutback_factor;
+    double m_fd_step;
+    bool m_predictor;
+    index m_stopping_reason;
+
+    // the linear solver holds a factorization of a recent hessian
+    bool m_is_factorized;
+
+    std::vector<double> m_step_parameters;
+    std::vector<double> m_step_sizes;
+    std::vector<index> m_step_iterations;
+    std::vector<index> m_step_cutbacks;
+    std::vector<double> m_step_times;
+
+    Vector m_x_converged;
+    Vector m_delta;
+    Vector m_df_0;
+    Vector m_df_lambda;
+    Vector m_tangent;
+
+private: // methods
+    LinearSolver& linear_solver()
+    {
+        return *m_problem->linear_solver();
+    }
+
+    bool factorize()
+    {
+        Trace::Span span("factorize");
+
+        return linear_solver().factorize(m_problem->hm_indptr(), m_problem->hm_indices(), m_problem->hm_values());
+    }
+
+    bool solve(Ref<const Vector> b, Ref<Vector> x)
+    {
+        Trace::Span span("solve");
+
+        return linear_solver().solve(m_problem->hm_indptr(), m_problem->hm_indices(), m_problem->hm_values(), b, x);
+    }
+
+    // returns the number of iterations or -1 if the corrector failed
+
+    index correct()
+    {
+        // only a factorization of this corrector run matches the state
+
+        m_is_factorized = false;
+
+        for (index iteration = 0; iteration < m_maxiter; iteration++) {
+            Trace::Span iteration_span("LoadStepping iteration");
+
+            m_problem->compute<false, 2>();
+            m_fevals += 1;
+            m_gevals += 1;
+            m_hevals += 1;
+
+            const double rnorm = m_problem->df().norm();
+
+            Log::task_info("Iteration {}: rnorm = {}", iteration + 1, rnorm);
+
+            if (!std::isfinite(rnorm)) {
+                return -1;
+            }
+
+            if (rnorm < m_rtol) {
+                return iteration;
+            }
+
+            m_is_factorized = !factorize();
+
+            if (!m_is_factorized || solve(m_problem->df(), m_delta)) {
+                return -1;
+            }
+
+            m_problem->sub_x(m_delta);
+
+            if (m_delta.norm() < m_xtol) {
+                m_problem->compute<false, 2>();
+                m_fevals += 1;
+                m_gevals += 1;
+                m_hevals += 1;
+
+                return iteration + 1;
+            }
+        }
+
+        return -1;
+    }
+
+    // expects hm and df of the converged state in the problem. The hessian is
+    // only factorized if the corrector has not done it yet
+
+    bool compute_tangent()
+    {
+        if (m_sensitivity) {
+            m_df_lambda = m_sensitivity();
+
+            if (length(m_df_lambda) != m_problem->nb_variables()) {
+                throw std::runtime_error("Sensitivity has an invalid size");
+            }
+        } else {
+            const double lambda = m_parameter->value();
+            const double h = m_fd_step * std::max(1.0, std::abs(lambda));
+
+            m_df_0 = m_problem->df();
+
+            m_parameter->set_value(lambda + h);
+            m_problem->compute<false, 1>();
+            m_fevals += 1;
+            m_gevals += 1;
+            m_parameter->set_value(lambda);
+
+            m_df_lambda = (m_problem->df() - m_df_0) / h;
+        }
+
+        if (!m_is_factorized) {
+            m_is_factorized = !factorize();
+
+            if (!m_is_factorized) {
+                return true;
+            }
+        }
+
+        return solve(m_df_lambda, m_tangent);
+    }
+
+    void record_step(const double step_size, const index iterations, const index cutbacks, const double time)
+    {
+        m_step_parameters.push_back(m_parameter->value());
+        m_step_sizes.push_back(step_size);
+        m_step_iterations.push_back(iterations);
+        m_step_cutbacks.push_back(cutbacks);
+        m_step_times.push_back(time);
+    }
+
+public: // constructor
+    LoadStepping(Pointer<Problem> problem, Pointer<Parameter> parameter, std::vector<double> schedule)
+        : m_problem(problem)
+        , m_parameter(parameter)
+        , m_schedule(schedule)
+        , m_maxiter(20)
+        , m_desired_iterations(4)
+        , m_max_cutbacks(10)
+        , m_fevals(0)
+        , m_gevals(0)
+        , m_hevals(0)
+        , m_rtol(1e-6)
+        , m_xtol(1e-10)
+        , m_initial_step(0.0)
+        , m_min_step(1e-8)
+        , m_max_step(infinity)
+        , m_cutback_factor(0.5)
+        , m_fd_step(1e-7)
+        , m_predictor(true)
+        , m_stopping_reason(-1)
+        , m_is_factorized(false)
+    {
+        if (problem->is_constrained()) {
+            throw std::runtime_error("Constraints are not supported");
+        }
+
+        if (schedule.empty()) {
+            throw std::invalid_argument("Schedule is empty");
+        }
+    }
+
+public: // methods
+    const std::vector<double>& schedule() const noexcept
+    {
+        return m_schedule;
+    }
+
+    void set_schedule(const std::vector<double>& value)
+    {
+        if (value.empty()) {
+            throw std::invalid_argument("Schedule is empty");
+        }
+
+        m_schedule = value;
+    }
+
+    Sensitivity sensitivity() const noexcept
+    {
+        return m_sensitivity;
+    }
+
+    void set_sensitivity(const Sensitivity& value) noexcept
+    {
+        m_sensitivity = value;
+    }
+
+    index maxiter() const noexcept
+    {
+        return m_maxiter;
+    }
+
+    void set_maxiter(const index value) noexcept
+    {
+        m_maxiter = value;
+    }
+
+    index desired_iterations() const noexcept
+    {
+        return m_desired_iterations;
+    }
+
+    void set_desired_iterations(const index value) noexcept
+    {
+        m_desired_iterations = value;
+    }
+
+    index max_cutbacks() const noexcept
+    {
+        return m_max_cutbacks;
+    }
+
+    void set_max_cutbacks(const index value) noexcept
+    {
+        m_max_cutbacks = value;
+    }
+
+    double rtol() const noexcept
+    {
+        return m_rtol;
+    }
+
+    void set_rtol(const double value) noexcept
+    {
+        m_rtol = value;
+    }
+
+    double xtol() const noexcept
+    {
+        return m_xtol;
+    }
+
+    void set_xtol(const double value) noexcept
+    {
+        m_xtol = value;
+    }
+
+    double initial_step() const noexcept
+    {
+        return m_initial_step;
+    }
+
+    void set_initial_step(const double value) noexcept
+    {
+        m_initial_step = value;
+    }
+
+    double min_step() const noexcept
+    {
+        return m_min_step;
+    }
+
+    void set_min_step(const double value) noexcept
+    {
+        m_min_step = value;
+    }
+
+    double max_step() const noexcept
+    {
+        return m_max_step;
+    }
+
+    void set_max_step(const double value) noexcept
+    {
+        m_max_step = value;
+    }
+
+    double cutback_factor() const noexcept
+    {
+        return m_cutback_factor;
+    }
+
+    void set_cutback_factor(const double value) noexcept
+    {
+        m_cutback_factor = value;
+    }
+
+    double fd_step() const noexcept
+    {
+        return m_fd_step;
+    }
+
+    void set_fd_step(const double value) noexcept
+    {
+        m_fd_step = value;
+    }
+
+    bool predictor() const noexcept
+    {
+        return m_predictor;
+    }
+
+    void set_predictor(const bool value) noexcept
+    {
+        m_predictor = value;
+    }
+
+    index fevals() const noexcept
+    {
+        return m_fevals;
+    }
+
+    index gevals() const noexcept
+    {
+        return m_gevals;
+    }
+
+    index hevals() const noexcept
+    {
+        return m_hevals;
+    }
+
+    index stopping_reason() const noexcept
+    {
+        return m_stopping_reason;
+    }
+
+    index nb_steps() const noexcept
+    {
+        return length(m_step_parameters);
+    }
+
+    Vector step_parameters() const
+    {
+        return Map<const Vector>(m_step_parameters.data(), nb_steps());
+    }
+
+    Vector step_sizes() const
+    {
+        return Map<const Vector>(m_step_sizes.data(), nb_steps());
+    }
+
+    IndexVector step_iterations() const
+    {
+        return Map<const IndexVector>(m_step_iterations.data(), nb_steps());
+    }
+
+    IndexVector step_cutbacks() const
+    {
+        return Map<const IndexVector>(m_step_cutbacks.data(), nb_steps());
+    }
+
+    Vector step_times() const
+    {
+        return Map<const Vector>(m_step_times.data(), nb_steps());
+    }
+
+    void run()
+    {
+        // setup
+
+        Log::task_begin("Solving load steps using Newton-Raphson with tangent predictor...");
+
+        Timer timer;
+
+        if (!(m_max_step > 0.0)) {
+            throw std::invalid_argument("The maximum step size must be positive");
+        }
+
+        const index n = m_problem->nb_variables();
+
+        m_is_factorized = false;
+
+        m_fevals = 0;
+        m_gevals = 0;
+        m_hevals = 0;
+        m_stopping_reason = 0;
+
+        m_step_parameters.clear();
+        m_step_sizes.clear();
+        m_step_iterations.clear();
+        m_step_cutbacks.clear();
+        m_step_times.clear();
+
+        m_x_converged.resize(n);
+        m_delta.resize(n);
+        m_df_0.resize(n);
+        m_df_lambda.resize(n);
+        m_tangent.resize(n);
+
+        // initial state
+
+        Log::task_step("Solving initial state with parameter = {}...", m_parameter->value());
+
+        if (correct() < 0) {
+            m_stopping_reason = 2;
+            Log::task_end("Stopped because the initial state could not be solved");
+            return;
+        }
+
+        // without an initial step size, the first step goes to the first
+        // schedule value which differs from the current parameter
+
+        double step = m_initial_step;
+
+        for (const double target : m_schedule) {
+            if (step > 0.0) {
+                break;
+            }
+
+            step = std::abs(target - m_parameter->value());
+        }
+
+        for (const double target : m_schedule) {
+            while (true) {
+                const double lambda = m_parameter->value();
+                const double remaining = target - lambda;
+
+                if (std::abs(remaining) <= 1e-14 * std::max(1.0, std::abs(target))) {
+                    m_parameter->set_value(target);
+                    break;
+                }
+
+                Timer step_timer;
+
+                m_x_converged = m_problem->x();
+
+                const bool tangent_failed = m_predictor && compute_tangent();
+
+                if (tangent_failed) {
+                    Log::task_info("Tangent could not be computed. Continue without predictor");
+                }
+
+                index cutbacks = 0;
+                index iterations = -1;
+                double dlambda = 0.0;
+
+                while (true) {
+                    if (!(step > 0.0)) {
+                        step = std::abs(remaining);
+                    }
+
+                    step = std::min(step, m_max_step);
+
+                    dlambda = std::abs(remaining) <= step ? remaining : std::copysign(step, remaining);
+
+                    Log::task_step("Solving step from parameter = {} to {}...", lambda, lambda + dlambda);
+
+                    if (m_predictor && !tangent_failed) {
+                        m_problem->sub_x(m_tangent * dlambda);
+                    }
+
+                    m_parameter->set_value(lambda + dlambda);
+
+                    iterations = correct();
+
+                    if (iterations >= 0) {
+                        break;
+                    }
+
+                    // restore last converged state and cut back
+
+                    m_problem->set_x(m_x_converged);
+                    m_parameter->set_value(lambda);
+
+                    step *= m_cutback_factor;
+                    cutbacks += 1;
+
+                    Log::task_info("Corrector failed. Cut back step size to {}", step);
+
+                    if (cutbacks > m_max_cutbacks || step < m_min_step) {
+                        break;
+                    }
+                }
+
+                if (iterations < 0) {
+                    m_stopping_reason = 1;
+                    m_problem->compute<false, 2>();
+                    m_fevals += 1;
+                    m_gevals += 1;
+                    m_hevals += 1;
+                    Log::task_end("Stopped at parameter = {} because the step size could not be reduced further", lambda);
+                    return;
+                }
+
+                record_step(dlambda, iterations, cutbacks, step_timer.ellapsed());
+
+                // adapt step size to the number of corrector iterations
+
+                const double ratio = double(m_desired_iterations) / std::max(index(1), iterations);
+
+                step = std::abs(dlambda) * std::clamp(std::sqrt(ratio), 0.5, 2.0);
+            }
+        }
+
+        Log::task_end("Load steps solved in {:.3f} sec", timer.ellapsed());
+    }
+
+public: // python
+    template <typename TModule>
+    static void register_python(TModule& m)
+    {
+        namespace py = pybind11;
+        using namespace pybind11::literals;
+
+        py::class_<Type>(m, "LoadStepping")
+            .def(py::init<Pointer<eqlib::Problem>, Pointer<eqlib::Parameter>, std::vector<double>>(), "problem"_a, "parameter"_a, "schedule"_a)
+            .def("run", &Type::run, py::call_guard<py::gil_scoped_release>())
+            // properties
+            .def_property("cutback_factor", &Type::cutback_factor, &Type::set_cutback_factor)
+            .def_property("desired_iterations", &Type::desired_iterations, &Type::set_desired_iterations)
+            .def_property("fd_step", &Type::fd_step, &Type::set_fd_step)
+            .def_property("initial_step", &Type::initial_step, &Type::set_initial_step)
+            .def_property("max_cutbacks", &Type::max_cutbacks, &Type::set_max_cutbacks)
+            .def_property("max_step", &Type::max_step, &Type::set_max_step)
+            .def_property("maxiter", &Type::maxiter, &Type::set_maxiter)
+            .def_property("min_step", &Type::min_step, &Type::set_min_step)
+            .def_property("predictor", &Type::predictor, &Type::set_predictor)
+            .def_property("rtol", &Type::rtol, &Type::set_rtol)
+            .def_property("schedule", &Type::schedule, &Type::set_schedule)
+            .def_property("sensitivity", &Type::sensitivity, &Type::set_sensitivity)
+            .def_property("xtol", &Type::xtol, &Type::set_xtol)
+            // read-only properties
+            .def_property_readonly("nb_steps", &Type::nb_steps)
+            .def_property_readonly("step_parameters", &Type::step_parameters)
+            .def_property_readonly("step_sizes", &Type::step_sizes)
+            .def_property_readonly("step_iterations", &Type::step_iterations)
+            .def_property_readonly("step_cutbacks", &Type::step_cutbacks)
+            .def_property_readonly("step_times", &Type::step_times)
+            .def_property_readonly("stopping_reason", &Type::stopping_reason)
+            .def_property_readonly("fevals", &Type::fevals)
+            .def_property_readonly("gevals", &Type::gevals)
+            .def_property_readonly("hevals", &Type::hevals);
+    }
+}; // class LoadStepping
+
+} // namespace eqlib
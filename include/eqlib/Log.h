@@ -47,31 +47,46 @@ public: // methods
         s_console->debug(std::forward<TArgs>(args)...);
     }
 
+    // the level is checked before the message is built, so suppressed
+    // messages are neither decorated nor formatted
+
     template <class... TArgs>
-    static void task_begin(std::string text, TArgs&&... args)
+    static void task_begin(const char* text, TArgs&&... args)
     {
-        std::string message = "\u001b[1;32m> " + text + "\u001b[0m";
-        info(1, message.c_str(), std::forward<TArgs>(args)...);
+        if (1 > info_level()) {
+            return;
+        }
+
+        const std::string message = "\u001b[1;32m> " + std::string(text) + "\u001b[0m";
+        info(message.c_str(), std::forward<TArgs>(args)...);
     }
 
     template <class... TArgs>
-    static void task_end(std::string text, TArgs&&... args)
+    static void task_end(const char* text, TArgs&&... args)
     {
-        info(1, text.c_str(), std::forward<TArgs>(args)...);
+        info(1, text, std::forward<TArgs>(args)...);
     }
 
     template <class... TArgs>
-    static void task_info(std::string text, TArgs&&... args)
+    static void task_info(const char* text, TArgs&&... args)
     {
-        std::string message = "\033[37m" + text + "\033[0m";
-        info(2, message.c_str(), std::forward<TArgs>(args)...);
+        if (2 > info_level()) {
+            return;
+        }
+
+        const std::string message = "\033[37m" + std::string(text) + "\033[0m";
+        info(message.c_str(), std::forward<TArgs>(args)...);
     }
 
     template <class... TArgs>
-    static void task_step(std::string text, TArgs&&... args)
+    static void task_step(const char* text, TArgs&&... args)
     {
-        std::string message = "\033[33m" + text + "\033[0m";
-        info(3, message.c_str(), std::forward<TArgs>(args)...);
+        if (3 > info_level()) {
+            return;
+        }
+
+        const std::string message = "\033[33m" + std::string(text) + "\033[0m";
+        info(message.c_str(), std::forward<TArgs>(args)...);
     }
 
     template <class... TArgs>
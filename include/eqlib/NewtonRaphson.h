@@ -4,7 +4,11 @@
 #include "Log.h"
 #include "Problem.h"
 #include "Settings.h"
+#include "Telemetry.h"
 #include "Timer.h"
+#include "Trace.h"
+
+#include <cmath>
 
 namespace eqlib {
 
@@ -25,15 +29,24 @@ private: // members
     double m_xtol;
     double m_damping;
     index m_stopping_reason;
+    Pointer<Telemetry> m_telemetry;
 
 private: // methods
 public: // constructor
     NewtonRaphson(Pointer<Problem> problem)
         : m_problem(problem)
+        , m_iterations(0)
         , m_maxiter(100)
+        , m_fevals(0)
+        , m_gevals(0)
+        , m_hevals(0)
+        , m_rnorm(0.0)
+        , m_xnorm(0.0)
         , m_rtol(1e-6)
         , m_xtol(1e-6)
         , m_damping(0.0)
+        , m_stopping_reason(-1)
+        , m_telemetry(new_<Telemetry>())
     {
         if (problem->is_constrained()) {
             throw std::runtime_error("Constraints are not supported");
@@ -106,6 +119,16 @@ public: // methods
         m_damping = value;
     }
 
+    index stopping_reason() const noexcept
+    {
+        return m_stopping_reason;
+    }
+
+    Pointer<Telemetry> telemetry() const noexcept
+    {
+        return m_telemetry;
+    }
+
     void run()
     {
         // setup
@@ -116,6 +139,20 @@ public: // methods
 
         const index n = m_problem->nb_variables();
 
+        LinearSolver& linear_solver = *m_problem->linear_solver();
+
+        const auto& ia = m_problem->hm_indptr();
+        const auto& ja = m_problem->hm_indices();
+
+        Vector delta(n);
+
+        m_iterations = 0;
+        m_fevals = 0;
+        m_gevals = 0;
+        m_hevals = 0;
+
+        m_telemetry->begin(m_maxiter + 1);
+
         for (index iteration = 0;; iteration++) {
             // check max iterations
 
@@ -125,31 +162,36 @@ public: // methods
                 break;
             }
 
-            Log::task_info("Iteration {}:", iteration + 1);
+            Trace::Span iteration_span("NewtonRaphson iteration");
 
             // compute g and h
 
+            Log::task_info("Iteration {}:", iteration + 1);
+
             Log::task_step("Computing system...");
 
+            Timer step_timer;
+
             m_problem->compute<false, 2>();
             m_gevals += 1;
             m_hevals += 1;
 
+            const double compute_time = step_timer.ellapsed();
+
             Log::task_info("The current value is {}", m_problem->f());
 
             // check residual
 
             Log::task_step("Computing residual...");
 
-            Vector m_residual = m_problem->df();
-
-            const double rnorm = m_residual.norm();
+            m_rnorm = m_problem->df().norm();
 
-            Log::task_info("The norm of the residual is {}", rnorm);
+            Log::task_info("The norm of the residual is {}", m_rnorm);
 
             // check residual norm
 
-            if (rnorm < m_rtol) {
+            if (m_rnorm < m_rtol) {
+                m_telemetry->record(m_problem->f(), m_rnorm, NAN, NAN, compute_time, 0.0, 0.0);
                 m_stopping_reason = 0;
                 Log::task_info("Stopped because rnorm < {}", m_rtol);
                 break;
@@ -163,27 +205,55 @@ public: // methods
                 m_problem->hm_add_diagonal(m_damping);
             }
 
-            Vector delta = m_problem->hm_inv_v(m_residual);
+            step_timer.start();
+
+            Trace::Span step_span("factorize");
+
+            // a problem without variables has nothing to factorize
+
+            if (n != 0 && linear_solver.factorize(ia, ja, m_problem->hm_values())) {
+                throw std::runtime_error("Factorization failed");
+            }
+
+            const double factorize_time = step_timer.ellapsed();
+
+            step_timer.start();
+
+            step_span.step("solve");
+
+            if (n != 0 && linear_solver.solve(ia, ja, m_problem->hm_values(), m_problem->df(), delta)) {
+                throw std::runtime_error("Solve failed");
+            }
+
+            step_span.end();
+
+            const double solve_time = step_timer.ellapsed();
 
             // update system
 
             Log::task_step("Updating system...");
 
-            m_problem->set_x(m_problem->x() - delta);
+            m_problem->sub_x(delta);
+
+            m_iterations = iteration + 1;
 
             // check x norm
 
-            const double xnorm = delta.norm();
+            m_xnorm = delta.norm();
 
-            Log::task_info("The norm of the step is {}", xnorm);
+            m_telemetry->record(m_problem->f(), m_rnorm, m_xnorm, 1.0, compute_time, factorize_time, solve_time);
 
-            if (xnorm < m_xtol) {
+            Log::task_info("The norm of the step is {}", m_xnorm);
+
+            if (m_xnorm < m_xtol) {
                 Log::task_info("Stopped because xnorm < {}", m_xtol);
                 m_stopping_reason = 1;
                 break;
             }
         }
 
+        m_telemetry->end();
+
         Log::task_end("System solved in {:.3f} sec", timer.ellapsed());
     }
 
@@ -201,9 +271,12 @@ public: // python
             .def_property("damping", &Type::damping, &Type::set_damping)
             .def_property("maxiter", &Type::maxiter, &Type::set_maxiter)
             .def_property("rtol", &Type::rtol, &Type::set_rtol)
+            .def_property("xtol", &Type::xtol, &Type::set_xtol)
             // read-only properties
             .def_property_readonly("iterations", &Type::iterations)
             .def_property_readonly("rnorm", &Type::rnorm)
+            .def_property_readonly("stopping_reason", &Type::stopping_reason)
+            .def_property_readonly("telemetry", &Type::telemetry)
             .def_property_readonly("fevals", &Type::fevals)
             .def_property_readonly("gevals", &Type::gevals)
             .def_property_readonly("hevals", &Type::hevals);
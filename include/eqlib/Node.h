@@ -27,13 +27,13 @@ private: // variables
 
 public: // constructors
     Node(const double x, const double y, const double z) noexcept
-        : m_ref_x(new_<Variable>(x))
+        : m_name("")
+        , m_ref_x(new_<Variable>(x))
         , m_ref_y(new_<Variable>(y))
         , m_ref_z(new_<Variable>(z))
         , m_act_x(new_<Variable>(x))
         , m_act_y(new_<Variable>(y))
         , m_act_z(new_<Variable>(z))
-        , m_name("")
     {
     }
 
@@ -42,6 +42,23 @@ public: // constructors
     {
     }
 
+    Node(
+        const Pointer<Variable>& ref_x,
+        const Pointer<Variable>& ref_y,
+        const Pointer<Variable>& ref_z,
+        const Pointer<Variable>& act_x,
+        const Pointer<Variable>& act_y,
+        const Pointer<Variable>& act_z) noexcept
+        : m_name("")
+        , m_ref_x(ref_x)
+        , m_ref_y(ref_y)
+        , m_ref_z(ref_z)
+        , m_act_x(act_x)
+        , m_act_y(act_y)
+        , m_act_z(act_z)
+    {
+    }
+
 public: // methods
     Pointer<Variable> ref_x() noexcept
     {
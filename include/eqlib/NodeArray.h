@@ -0,0 +1,180 @@
+#pragma once
+
+#include "Define.h"
+#include "Node.h"
+#include "VariableArray.h"
+
+#include <stdexcept>
+#include <vector>
+
+namespace eqlib {
+
+/*
+* A set of nodes created in one step. The reference and actual coordinates
+* are stored in two variable arrays ordered x, y, z for each node, so the
+* locations can be accessed as nb_nodes x 3 arrays. The handles of the single
+* nodes share the ownership of the whole array.
+*/
+class NodeArray {
+public: // types
+    using View = Eigen::Map<Matrix, 0, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>>;
+
+private: // types
+    using Type = NodeArray;
+
+    struct Storage {
+        VariableArray ref_variables;
+        VariableArray act_variables;
+        std::vector<Node> nodes;
+
+        Storage(Ref<const Vector> ref_values, Ref<const Vector> act_values)
+            : ref_variables(ref_values)
+            , act_variables(act_values)
+        {
+        }
+    };
+
+private: // variables
+    Pointer<Storage> m_storage;
+
+public: // constructors
+    NodeArray(Ref<const Matrix> locations)
+    {
+        if (locations.cols() != 3) {
+            throw std::invalid_argument("Locations must be an array of shape (nb_nodes, 3)");
+        }
+
+        const Matrix values = locations;
+
+        const Map<const Vector> flat_values(values.data(), values.size());
+
+        m_storage = new_<Storage>(flat_values, flat_values);
+
+        auto& storage = *m_storage;
+
+        const auto ref_variables = storage.ref_variables.variables();
+        const auto act_variables = storage.act_variables.variables();
+
+        storage.nodes.reserve(locations.rows());
+
+        for (index i = 0; i < locations.rows(); i++) {
+            storage.nodes.emplace_back(
+                ref_variables[i * 3 + 0], ref_variables[i * 3 + 1], ref_variables[i * 3 + 2],
+                act_variables[i * 3 + 0], act_variables[i * 3 + 1], act_variables[i * 3 + 2]);
+        }
+    }
+
+private: // methods
+    View view(VariableArray::View values) const noexcept
+    {
+        return View(values.data(), size(), 3, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>(values.innerStride() * 3, values.innerStride()));
+    }
+
+    void check_shape(Ref<const Matrix> value) const
+    {
+        if (value.rows() != size() || value.cols() != 3) {
+            throw std::invalid_argument(format("Expected an array of shape ({}, 3)", size()));
+        }
+    }
+
+public: // methods
+    index size() const noexcept
+    {
+        return length(m_storage->nodes);
+    }
+
+    Pointer<Node> node(const index i) const
+    {
+        if (i < 0 || size() <= i) {
+            throw std::out_of_range("Index out of range");
+        }
+
+        // the handle shares the ownership of the storage
+
+        return Pointer<Node>(m_storage, &m_storage->nodes[i]);
+    }
+
+    std::vector<Pointer<Node>> nodes() const
+    {
+        std::vector<Pointer<Node>> result(size());
+
+        for (index i = 0; i < size(); i++) {
+            result[i] = Pointer<Node>(m_storage, &m_storage->nodes[i]);
+        }
+
+        return result;
+    }
+
+    VariableArray ref_variables() const noexcept
+    {
+        return m_storage->ref_variables;
+    }
+
+    VariableArray act_variables() const noexcept
+    {
+        return m_storage->act_variables;
+    }
+
+    View ref_locations() const noexcept
+    {
+        return view(m_storage->ref_variables.values());
+    }
+
+    void set_ref_locations(Ref<const Matrix> value)
+    {
+        check_shape(value);
+        ref_locations() = value;
+    }
+
+    View act_locations() const noexcept
+    {
+        return view(m_storage->act_variables.values());
+    }
+
+    void set_act_locations(Ref<const Matrix> value)
+    {
+        check_shape(value);
+        act_locations() = value;
+    }
+
+    // the displacements are derived from the locations, so they are returned
+    // as a copy
+
+    Matrix displacements() const
+    {
+        return act_locations() - ref_locations();
+    }
+
+    void set_displacements(Ref<const Matrix> value)
+    {
+        check_shape(value);
+        act_locations() = ref_locations() + value;
+    }
+
+public: // python
+    template <typename TModule>
+    static void register_python(TModule& m)
+    {
+        namespace py = pybind11;
+        using namespace pybind11::literals;
+
+        using Holder = Pointer<Type>;
+
+        py::class_<Type, Holder>(m, "NodeArray")
+            // constructors
+            .def(py::init<Ref<const Matrix>>(), "locations"_a)
+            // methods
+            .def("__len__", &Type::size)
+            .def("__getitem__", &Type::node, "index"_a)
+            // read-only properties
+            .def_property_readonly("nodes", &Type::nodes)
+            .def_property_readonly("ref_variables", &Type::ref_variables)
+            .def_property_readonly("act_variables", &Type::act_variables)
+            // properties
+            .def_property("ref_locations", &Type::ref_locations, &Type::set_ref_locations)
+            .def_property("act_locations", &Type::act_locations, &Type::set_act_locations)
+            .def_property("displacements", &Type::displacements, &Type::set_displacements);
+    }
+};
+
+} // namespace eqlib
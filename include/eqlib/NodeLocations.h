@@ -0,0 +1,251 @@
+#pragma once
+
+#include "BinaryFile.h"
+#include "Define.h"
+#include "Node.h"
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace eqlib {
+
+// node slots of one element. An empty view reads the locations from the
+// nodes, e.g. if the element is computed outside of a problem
+
+class NodeLocationsView {
+public: // types
+    using Locations = Eigen::Matrix<double, Eigen::Dynamic, 3>;
+
+private: // variables
+    const Locations* m_locations;
+    const index* m_slots;
+
+public: // constructors
+    NodeLocationsView() noexcept
+        : m_locations(nullptr)
+        , m_slots(nullptr)
+    {
+    }
+
+    NodeLocationsView(const Locations& locations, const index* slots) noexcept
+        : m_locations(&locations)
+        , m_slots(slots)
+    {
+    }
+
+public: // methods
+    bool empty() const noexcept
+    {
+        return m_locations == nullptr;
+    }
+
+    // locations of the given nodes of the element. The offset is the
+    // position of the first node within the gathered nodes of the element
+
+    template <int TNbNodes = Eigen::Dynamic>
+    Eigen::Matrix<double, TNbNodes, 3> gather(const std::vector<Pointer<Node>>& nodes, const index offset = 0) const
+    {
+        Eigen::Matrix<double, TNbNodes, 3> result(length(nodes), 3);
+
+        if (empty()) {
+            for (index i = 0; i < length(nodes); i++) {
+                result.row(i) = nodes[i]->act_location();
+            }
+        } else {
+            for (index i = 0; i < length(nodes); i++) {
+                result.row(i) = m_locations->row(m_slots[offset + i]);
+            }
+        }
+
+        return result;
+    }
+}; // class NodeLocationsView
+
+/*
+* Actual locations of the nodes of a problem in one contiguous nb_nodes x 3
+* array.
+*
+* The problem gathers the locations once at the beginning of a computation.
+* The elements read the rows of their nodes through precomputed node slots
+* instead of dereferencing three variables per node. The slots of element i
+* are stored in one flat array between offset(i) and offset(i + 1).
+*
+* If the problem owns the values of its variables, the locations are gathered
+* from this contiguous array by the indices of the x, y and z variables.
+*/
+class NodeLocations {
+public: // types
+    using Locations = NodeLocationsView::Locations;
+    using View = NodeLocationsView;
+
+private: // variables
+    std::vector<Pointer<Node>> m_nodes;
+    std::vector<index> m_offsets;
+    std::vector<index> m_slots;
+    std::vector<index> m_variable_indices;
+    Locations m_locations;
+
+public: // constructor
+    NodeLocations()
+        : m_offsets(1, 0)
+    {
+    }
+
+public: // methods
+    index nb_nodes() const noexcept
+    {
+        return length(m_nodes);
+    }
+
+    index nb_elements() const noexcept
+    {
+        return length(m_offsets) - 1;
+    }
+
+    bool empty() const noexcept
+    {
+        return m_nodes.empty();
+    }
+
+    // collects the gathered nodes of the elements in the order of their
+    // first occurrence and assigns the node slots
+
+    template <typename TElements>
+    void initialize(const TElements& elements)
+    {
+        DenseMap<const Node*, index> lookup;
+
+        lookup.set_empty_key(nullptr);
+
+        m_nodes.clear();
+        m_slots.clear();
+        m_offsets.assign(1, 0);
+
+        for (const auto& element : elements) {
+            for (const auto& node : element->gathered_nodes()) {
+                const auto [it, inserted] = lookup.insert(std::make_pair(static_cast<const Node*>(node.get()), length(m_nodes)));
+
+                if (inserted) {
+                    m_nodes.push_back(node);
+                }
+
+                m_slots.push_back(it->second);
+            }
+
+            m_offsets.push_back(length(m_slots));
+        }
+
+        m_variable_indices.clear();
+
+        m_locations.resize(length(m_nodes), 3);
+    }
+
+    // stores the indices of the x, y and z variables of the nodes in the
+    // problem or -1 if a variable is not part of it
+
+    template <typename TVariableIndex>
+    void assign_variables(TVariableIndex&& variable_index)
+    {
+        m_variable_indices.resize(length(m_nodes) * 3);
+
+        for (index i = 0; i < length(m_nodes); i++) {
+            auto& node = *m_nodes[i];
+
+            m_variable_indices[i * 3 + 0] = variable_index(node.x());
+            m_variable_indices[i * 3 + 1] = variable_index(node.y());
+            m_variable_indices[i * 3 + 2] = variable_index(node.z());
+        }
+    }
+
+    // copies the actual locations of the nodes into the contiguous array
+
+    void gather()
+    {
+        for (index i = 0; i < length(m_nodes); i++) {
+            m_locations.row(i) = m_nodes[i]->act_location();
+        }
+    }
+
+    // copies the actual locations from the values of the variables owned by
+    // the problem. Only variables which are not part of the problem are read
+    // through the nodes
+
+    void gather(const Vector& values)
+    {
+        for (index i = 0; i < length(m_nodes); i++) {
+            for (index k = 0; k < 3; k++) {
+                const index variable_index = m_variable_indices[i * 3 + k];
+
+                if (variable_index != -1) {
+                    m_locations(i, k) = values(variable_index);
+                } else {
+                    m_locations(i, k) = m_nodes[i]->act_location()(k);
+                }
+            }
+        }
+    }
+
+    View view(const index i) const noexcept
+    {
+        return View(m_locations, m_slots.data() + m_offsets[i]);
+    }
+
+    void write(std::ostream& stream) const
+    {
+        binary_file::write(stream, static_cast<std::int64_t>(nb_nodes()));
+        binary_file::write(stream, m_offsets);
+        binary_file::write(stream, m_slots);
+    }
+
+    // reads the node slots and takes the nodes from the elements
+
+    template <typename TElements>
+    void read(std::istream& stream, const TElements& elements)
+    {
+        std::int64_t nb_nodes;
+
+        binary_file::read(stream, nb_nodes);
+        binary_file::read(stream, m_offsets);
+        binary_file::read(stream, m_slots);
+
+        if (nb_nodes < 0 || length(m_offsets) != length(elements) + 1 || m_offsets.front() != 0 || m_offsets.back() != length(m_slots)) {
+            throw std::runtime_error("Invalid node slots");
+        }
+
+        m_nodes.assign(nb_nodes, nullptr);
+
+        for (index i = 0; i < length(elements); i++) {
+            const auto nodes = elements[i]->gathered_nodes();
+
+            if (length(nodes) != m_offsets[i + 1] - m_offsets[i]) {
+                throw std::runtime_error("The elements do not match the saved problem");
+            }
+
+            for (index k = 0; k < length(nodes); k++) {
+                const index slot = m_slots[m_offsets[i] + k];
+
+                if (slot < 0 || slot >= nb_nodes || (m_nodes[slot] != nullptr && m_nodes[slot] != nodes[k])) {
+                    throw std::runtime_error("The elements do not match the saved problem");
+                }
+
+                m_nodes[slot] = nodes[k];
+            }
+        }
+
+        for (const auto& node : m_nodes) {
+            if (node == nullptr) {
+                throw std::runtime_error("The elements do not match the saved problem");
+            }
+        }
+
+        m_variable_indices.clear();
+
+        m_locations.resize(nb_nodes, 3);
+    }
+}; // class NodeLocations
+
+} // namespace eqlib
@@ -8,18 +8,25 @@
 
 namespace eqlib {
 
+class Node;
+class NodeLocationsView;
+
 class Objective {
 private: // types
     using Type = Objective;
 
 protected: // variables
-    std::string m_name;
-    bool m_is_active;
     std::vector<Pointer<Variable>> m_variables;
+    bool m_is_active;
+    bool m_has_constant_hessian;
+    index m_revision;
+    std::string m_name;
 
 public: // constructors
     Objective()
         : m_is_active(true)
+        , m_has_constant_hessian(false)
+        , m_revision(0)
         , m_name("")
     {
     }
@@ -27,6 +34,8 @@ public: // constructors
     Objective(const index nb_variables)
         : m_variables(nb_variables)
         , m_is_active(true)
+        , m_has_constant_hessian(false)
+        , m_revision(0)
         , m_name("")
     {
     }
@@ -51,6 +60,22 @@ public: // methods
 
     virtual double compute(Ref<Vector> g, Ref<Matrix> h) const = 0;
 
+    // nodes whose actual locations the problem gathers into a contiguous
+    // array before each computation
+
+    virtual std::vector<Pointer<Node>> gathered_nodes() const
+    {
+        return {};
+    }
+
+    // computes the objective with the locations of the gathered nodes. The
+    // problem calls this instead of compute
+
+    virtual double compute_gathered(Ref<Vector> g, Ref<Matrix> h, const NodeLocationsView&) const
+    {
+        return compute(g, h);
+    }
+
     bool is_active() const noexcept
     {
         return m_is_active;
@@ -61,6 +86,26 @@ public: // methods
         m_is_active = value;
     }
 
+    // an objective with a constant hessian (and a gradient which is affine in
+    // x) is evaluated only once at order 2. The problem caches its hessian
+
+    bool has_constant_hessian() const noexcept
+    {
+        return m_has_constant_hessian;
+    }
+
+    void set_constant_hessian(const bool value) noexcept
+    {
+        m_has_constant_hessian = value;
+    }
+
+    // counts the changes of the objective which invalidate a cached hessian
+
+    index revision() const noexcept
+    {
+        return m_revision;
+    }
+
     const std::string& name() const
     {
         return m_name;
@@ -77,6 +122,14 @@ protected: // methods
         m_variables = value;
     }
 
+    // has to be called if the hessian has changed, e.g. after adding
+    // integration points
+
+    void increment_revision() noexcept
+    {
+        m_revision += 1;
+    }
+
 public: // python
     template <typename T>
     class PyObjective : public T {
@@ -106,7 +159,9 @@ public: // python
             .def(py::init<index>(), "nb_variables"_a)
             // read-only properties
             .def_property_readonly("nb_variables", &Type::nb_variables)
+            .def_property_readonly("revision", &Type::revision)
             // properties
+            .def_property("constant_hessian", &Type::has_constant_hessian, &Type::set_constant_hessian)
             .def_property("is_active", &Type::is_active, &Type::set_active)
             .def_property("name", &Type::name, &Type::set_name)
             .def_property("variables", &Type::variables, &Type::set_variables)
@@ -56,6 +56,8 @@ public: // constructors
         m_iparm[19] = 0; // Output: Numbers of CG Iterations
 
         m_iparm[20] = 0; // 1x1 pivoting
+        m_iparm[21] = -1; // Output: Number of positive eigenvalues
+        m_iparm[22] = -1; // Output: Number of negative eigenvalues
         m_iparm[26] = 0; // No matrix checker
         m_iparm[27] = 0; // 0: double, 1: float
         m_iparm[34] = 1; // C indexing
@@ -171,6 +173,15 @@ public: // methods
         return (error != 0);
     }
 
+    index nb_negative_pivots() const override
+    {
+        if (!m_is_analyzed) {
+            return -1;
+        }
+
+        return m_iparm[22];
+    }
+
 public: // python
     template <typename TModule>
     static void register_python(TModule& m)
@@ -1,8 +1,13 @@
 #pragma once
 
+#include "BatchObjective.h"
+#include "BinaryFile.h"
 #include "Constraint.h"
 #include "Define.h"
+#include "ElementIndices.h"
+#include "Future.h"
 #include "LinearSolver.h"
+#include "NodeLocations.h"
 #include "Objective.h"
 #ifdef EQLIB_USE_MKL
 #include "PardisoLDLT.h"
@@ -12,11 +17,19 @@
 #include "SimplicialLDLT.h"
 #include "SparseStructure.h"
 #include "Timer.h"
+#include "Trace.h"
 
 #include <omp.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <future>
 #include <mutex>
 #include <set>
+#include <string>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -33,23 +46,16 @@ private: // types
     using Equations = std::vector<Pointer<Equation>>;
     using Variables = std::vector<Pointer<Variable>>;
 
-    struct Index {
-        index local;
-        index global;
+private: // variables
+    static inline std::atomic<size_t> s_next_id{1};
 
-        Index(index local, index global)
-            : local(local)
-            , global(global)
-        {
-        }
+    // "EQLIBPRB" in little endian and the version of the binary file format
 
-        bool operator<(const Index& other) const noexcept
-        {
-            return global < other.global;
-        }
-    };
+    static constexpr std::uint64_t s_file_magic = 0x42525042494C5145ull;
+    static constexpr std::uint64_t s_file_version = 2;
+
+    size_t m_id;
 
-private: // variables
     double m_sigma;
 
     int m_nb_threads;
@@ -61,11 +67,19 @@ private: // variables
     std::vector<index> m_active_elements_f;
     std::vector<index> m_active_elements_g;
 
+    // batches of the objectives. Each batch is computed once at the beginning
+    // of a computation and its elements copy the results
+
+    std::vector<Pointer<BatchObjective::Batch>> m_batches;
+
     Equations m_equations;
     Variables m_variables;
 
-    DenseMap<Pointer<Equation>, index> m_equation_indices;
-    DenseMap<Pointer<Variable>, index> m_variable_indices;
+    // lookup for equations and variables whose slot was taken over by a
+    // problem which was set up later. Created on the first miss
+
+    mutable Pointer<DenseMap<const Equation*, index>> m_equation_indices;
+    mutable Pointer<DenseMap<const Variable*, index>> m_variable_indices;
 
     std::vector<index> m_element_f_nb_variables;
     std::vector<index> m_element_g_nb_variables;
@@ -74,39 +88,90 @@ private: // variables
     index m_max_element_n;
     index m_max_element_m;
 
-    std::vector<std::vector<Index>> m_element_f_variable_indices;
-    std::vector<std::vector<Index>> m_element_g_equation_indices;
-    std::vector<std::vector<Index>> m_element_g_variable_indices;
+    // the variable indices of the objectives also store the upper bound of
+    // the row in the hessian for each variable as hm offset
 
-    std::vector<std::vector<index>> m_element_f_variable_indices_hi;
+    ElementIndices m_element_f_variable_indices;
+    ElementIndices m_element_g_equation_indices;
+    ElementIndices m_element_g_variable_indices;
 
     SparseStructure<double, int, true> m_structure_dg;
     SparseStructure<double, int, true> m_structure_hm;
 
+    // actual locations of the gathered nodes of the objectives and the node
+    // slots of each objective
+
+    NodeLocations m_node_locations;
+
     ProblemData m_data;
 
+    // hessian of the active objectives with a constant hessian. It is
+    // computed once and added to hm at order 2. The revisions of the
+    // objectives at this time detect later changes
+
+    std::vector<index> m_constant_elements_f;
+    std::vector<index> m_constant_revisions_f;
+    Vector m_hm_constant;
+    bool m_hm_constant_valid;
+
     Pointer<LinearSolver> m_linear_solver;
 
+    // point of the last computation by compute_at. The results are reused if
+    // x, the equation multipliers and sigma are unchanged and no other
+    // computation happened in between. An order of -1 marks an empty cache
+
+    Vector m_cached_x;
+    Vector m_cached_equation_multipliers;
+    double m_cached_sigma;
+    index m_cached_order;
+
+    // state of the variables if they are owned by the problem. It is mutable
+    // like the state of the variables behind m_variables
+
+    bool m_owns_variables;
+
+    mutable Vector m_variable_values;
+    mutable Vector m_variable_lower_bounds;
+    mutable Vector m_variable_upper_bounds;
+    mutable Vector m_variable_multiplier_values;
+    VariableStorage m_variable_storage;
+
+    // operations running on a worker thread. They are declared last, so they
+    // finish before the other members are destroyed
+
+    std::shared_future<void> m_pending_compute;
+    std::shared_future<Vector> m_pending_hm_inv_v;
+
 public: // constructors
     Problem()
+        : m_id(s_next_id++)
+        , m_hm_constant_valid(false)
+        , m_cached_order(-1)
+        , m_owns_variables(false)
     {
     }
 
     Problem(ElementsF elements_f, ElementsG elements_g, const int nb_threads = 1, const int grainsize = 100)
-        : m_elements_f(std::move(elements_f))
-        , m_elements_g(std::move(elements_g))
+        : m_id(s_next_id++)
         , m_sigma(1.0)
         , m_nb_threads(nb_threads)
         , m_grainsize(grainsize)
-        , m_max_element_n(0)
-        , m_max_element_m(0)
+        , m_elements_f(std::move(elements_f))
+        , m_elements_g(std::move(elements_g))
         , m_active_elements_f(length(m_elements_f))
         , m_active_elements_g(length(m_elements_g))
+        , m_max_element_n(0)
+        , m_max_element_m(0)
+        , m_hm_constant_valid(false)
+        , m_cached_order(-1)
+        , m_owns_variables(false)
     {
         Log::task_begin("Initialize problem...");
 
         Timer timer;
 
+        Trace::Span span("Problem::Problem");
+
         const auto nb_elements_f = length(m_elements_f);
         const auto nb_elements_g = length(m_elements_g);
 
@@ -114,82 +179,28 @@ public: // constructors
         Log::task_info("The constraints consist of {} elements", nb_elements_g);
 
         Log::task_step("Getting equations and variables...");
+        Trace::Span phase("element sizes");
 
-        m_element_f_nb_variables.resize(nb_elements_f);
-        m_element_g_nb_variables.resize(nb_elements_g);
-        m_element_g_nb_equations.resize(nb_elements_g);
+        initialize_element_sizes();
 
-        for (index i = 0; i < nb_elements_f; i++) {
-            const auto& element = *m_elements_f[i];
-
-            const index nb_variables = element.nb_variables();
-
-            m_element_f_nb_variables[i] = nb_variables;
-            m_max_element_n = std::max(m_max_element_n, nb_variables);
-        }
-
-        for (index i = 0; i < nb_elements_g; i++) {
-            const auto& element = *m_elements_g[i];
-
-            const index nb_equations = element.nb_equations();
-            const index nb_variables = element.nb_variables();
-
-            m_element_g_nb_variables[i] = nb_variables;
-            m_element_g_nb_equations[i] = nb_equations;
-
-            m_max_element_n = std::max(m_max_element_n, nb_variables);
-            m_max_element_m = std::max(m_max_element_m, nb_equations);
-        }
+        // the slot of an equation or variable marks it as seen by this
+        // problem and stores its global index
 
         Log::task_step("Creating the set of unique equations...");
+        phase.step("unique equations");
 
-        RobinSet<Pointer<Equation>> equation_set;
-
-        for (const auto& element : m_elements_g) {
-            for (const auto& equation : element->equations()) {
-                if (!equation->is_active()) {
-                    continue;
-                }
-
-                const auto [_, is_new] = equation_set.insert(equation);
-
-                if (is_new) {
-                    m_equations.push_back(equation);
-                }
-            }
-        }
+        collect_unique(nb_elements_g, [&](const index i) -> const Equations& {
+            return m_elements_g[i]->equations();
+        }, m_equations);
 
         Log::task_step("Creating the set of unique variables...");
+        phase.step("unique variables");
 
-        RobinSet<Pointer<Variable>> variable_set;
+        collect_unique(nb_elements_f + nb_elements_g, [&](const index i) -> const Variables& {
+            return i < nb_elements_f ? m_elements_f[i]->variables() : m_elements_g[i - nb_elements_f]->variables();
+        }, m_variables);
 
-        for (const auto& element : m_elements_f) {
-            for (const auto& variable : element->variables()) {
-                if (!variable->is_active()) {
-                    continue;
-                }
-
-                const auto [_, is_new] = variable_set.insert(variable);
-
-                if (is_new) {
-                    m_variables.push_back(variable);
-                }
-            }
-        }
-
-        for (const auto& element : m_elements_g) {
-            for (const auto& variable : element->variables()) {
-                if (!variable->is_active()) {
-                    continue;
-                }
-
-                const auto [_, is_new] = variable_set.insert(variable);
-
-                if (is_new) {
-                    m_variables.push_back(variable);
-                }
-            }
-        }
+        initialize_batches();
 
         const auto nb_equations = length(m_equations);
         const auto nb_variables = length(m_variables);
@@ -197,56 +208,48 @@ public: // constructors
         Log::task_info("The problem contains {} variables", nb_variables);
         Log::task_info("The problem contains {} constraint equations", nb_equations);
 
-        Log::task_step("Compute indices for variables and equations...");
+        Log::task_step("Compute indices for elements...");
+        phase.step("element indices");
 
-        m_equation_indices.set_empty_key(nullptr);
-        m_variable_indices.set_empty_key(nullptr);
+        ElementIndices::check_range(nb_variables);
+        ElementIndices::check_range(nb_equations);
 
-        m_equation_indices.resize(nb_equations);
-        m_variable_indices.resize(nb_variables);
+        std::vector<index> element_f_sizes(nb_elements_f);
+        std::vector<index> element_g_equation_sizes(nb_elements_g);
+        std::vector<index> element_g_variable_sizes(nb_elements_g);
 
-        for (index i = 0; i < length(m_equations); i++) {
-            const auto& equation = m_equations[i];
-            m_equation_indices[equation] = i;
+        for (index i = 0; i < nb_elements_f; i++) {
+            element_f_sizes[i] = count_active(m_elements_f[i]->variables());
         }
 
-        for (index i = 0; i < length(m_variables); i++) {
-            const auto& variable = m_variables[i];
-            m_variable_indices[variable] = i;
+        for (index i = 0; i < nb_elements_g; i++) {
+            element_g_equation_sizes[i] = count_active(m_elements_g[i]->equations());
+            element_g_variable_sizes[i] = count_active(m_elements_g[i]->variables());
         }
 
-        Log::task_step("Compute indices for elements...");
-
-        // variable indices f
-
-        m_element_f_variable_indices.resize(nb_elements_f);
-        m_element_g_equation_indices.resize(nb_elements_g);
-        m_element_g_variable_indices.resize(nb_elements_g);
+        m_element_f_variable_indices.allocate(element_f_sizes);
+        m_element_g_equation_indices.allocate(element_g_equation_sizes);
+        m_element_g_variable_indices.allocate(element_g_variable_sizes);
 
         #pragma omp parallel if (m_nb_threads != 1) num_threads(m_nb_threads)
         {
+            // variable indices f
+
             #pragma omp for schedule(dynamic, m_grainsize) nowait
             for (index i = 0; i < nb_elements_f; i++) {
                 const auto& variables = m_elements_f[i]->variables();
 
-                std::vector<Index> variable_indices;
-                variable_indices.reserve(variables.size());
+                auto entries = m_element_f_variable_indices.entries(i);
 
                 for (index local = 0; local < length(variables); local++) {
                     const auto& variable = variables[local];
 
-                    if (!variable->is_active()) {
-                        continue;
+                    if (variable->is_active()) {
+                        *entries++ = {local, variable->slot_index()};
                     }
-
-                    const auto global = m_variable_indices[variable];
-
-                    variable_indices.emplace_back(local, global);
                 }
 
-                std::sort(variable_indices.begin(), variable_indices.end());
-
-                m_element_f_variable_indices[i] = std::move(variable_indices);
+                std::sort(m_element_f_variable_indices.entries(i), entries);
             }
 
             // equation indices g
@@ -255,22 +258,15 @@ public: // constructors
             for (index i = 0; i < nb_elements_g; i++) {
                 const auto& equations = m_elements_g[i]->equations();
 
-                std::vector<Index> equation_indices;
-                equation_indices.reserve(equations.size());
+                auto entries = m_element_g_equation_indices.entries(i);
 
                 for (index local = 0; local < length(equations); local++) {
                     const auto& equation = equations[local];
 
-                    if (!equation->is_active()) {
-                        continue;
+                    if (equation->is_active()) {
+                        *entries++ = {local, equation->slot_index()};
                     }
-
-                    const auto global = m_equation_indices[equation];
-
-                    equation_indices.emplace_back(local, global);
                 }
-
-                m_element_g_equation_indices[i] = std::move(equation_indices);
             }
 
             // variable indices g
@@ -279,28 +275,31 @@ public: // constructors
             for (index i = 0; i < nb_elements_g; i++) {
                 const auto& variables = m_elements_g[i]->variables();
 
-                std::vector<Index> variable_indices;
-                variable_indices.reserve(variables.size());
+                auto entries = m_element_g_variable_indices.entries(i);
 
                 for (index local = 0; local < length(variables); local++) {
                     const auto& variable = variables[local];
 
-                    if (!variable->is_active()) {
-                        continue;
+                    if (variable->is_active()) {
+                        *entries++ = {local, variable->slot_index()};
                     }
-
-                    const auto global = m_variable_indices[variable];
-
-                    variable_indices.emplace_back(local, global);
                 }
 
-                std::sort(variable_indices.begin(), variable_indices.end());
-
-                m_element_g_variable_indices[i] = std::move(variable_indices);
+                std::sort(m_element_g_variable_indices.entries(i), entries);
             }
         }
 
+        Log::task_step("Assign node slots...");
+        phase.step("node slots");
+
+        m_node_locations.initialize(m_elements_f);
+
+        assign_node_variables();
+
+        Log::task_info("The objectives gather the locations of {} nodes", m_node_locations.nb_nodes());
+
         Log::task_step("Analyse sparse patterns...");
+        phase.step("sparse patterns");
 
         const auto n = length(m_variables);
         const auto m = length(m_equations);
@@ -317,7 +316,7 @@ public: // constructors
             const auto thread_id = omp_get_thread_num();
 
             for (index i = 0; i < length(m_elements_f); i++) {
-                const auto& variable_indices = m_element_f_variable_indices[i];
+                const auto variable_indices = m_element_f_variable_indices[i];
 
                 for (index row_i = 0; row_i < length(variable_indices); row_i++) {
                     const auto row = variable_indices[row_i];
@@ -335,8 +334,8 @@ public: // constructors
             }
 
             for (index i = 0; i < length(m_elements_g); i++) {
-                const auto& equation_indices = m_element_g_equation_indices[i];
-                const auto& variable_indices = m_element_g_variable_indices[i];
+                const auto equation_indices = m_element_g_equation_indices[i];
+                const auto variable_indices = m_element_g_variable_indices[i];
 
                 for (const auto row : equation_indices) {
                     if ((row.global / grainsize) % current_nb_threats != thread_id) {
@@ -397,6 +396,7 @@ public: // constructors
         }
 
         Log::task_step("Allocate memory...");
+        phase.step("allocate memory");
 
         m_structure_dg = SparseStructure<double, int, true>::from_pattern(m, n, pattern_dg);
         m_structure_hm = SparseStructure<double, int, true>::from_pattern(n, n, pattern_hm);
@@ -407,37 +407,480 @@ public: // constructors
 
         m_data.resize(n, m, m_structure_dg.nb_nonzeros(), m_structure_hm.nb_nonzeros(), m_max_element_n, m_max_element_m);
 
-        Log::task_info("The problem occupies {} MB", m_data.values().size() * 8.0 / 1'024 / 1'024);
+        Log::task_step("Initialize element boundaries...");
+        phase.step("element boundaries");
+
+        m_element_f_variable_indices.allocate_hm_offsets();
+
+        for (index i = 0; i < nb_elements_f; i++) {
+            const auto element_indices = m_element_f_variable_indices[i];
+
+            auto element_hi = m_element_f_variable_indices.hm_offsets(i);
+
+            for (index row_i = 0; row_i < length(element_indices); row_i++) {
+                const auto row = element_indices[row_i];
+                const auto col = element_indices.back();
+
+                element_hi[row_i] = static_cast<std::int32_t>(m_structure_hm.get_index(row.global, col.global) + 1);
+            }
+        }
+
+        const auto element_indices_memory = m_element_f_variable_indices.memory_usage() + m_element_g_equation_indices.memory_usage() + m_element_g_variable_indices.memory_usage();
+        const auto nested_element_indices_memory = m_element_f_variable_indices.nested_memory_usage() + m_element_g_equation_indices.nested_memory_usage() + m_element_g_variable_indices.nested_memory_usage();
+
+        Log::task_info("The problem occupies {} MB", m_data.values().size() * 8.0 / 1'024 / 1'024);
+
+        Log::task_info("The element indices occupy {} MB (saved {} MB)", element_indices_memory / 1'024.0 / 1'024, (double(nested_element_indices_memory) - double(element_indices_memory)) / 1'024 / 1'024);
+
+        Log::task_step("Initialize linear solver...");
+        phase.step("linear solver");
+
+        #ifdef EQLIB_USE_MKL
+        m_linear_solver = new_<PardisoLDLT>();
+        #else
+        m_linear_solver = new_<SimplicialLDLT>();
+        #endif
+
+        Log::task_end("Problem initialized in {:.3f} sec", timer.ellapsed());
+    }
+
+private: // constructors
+    // restores the problem from a file written by save instead of analysing
+    // the elements. The elements are only checked against the saved indices
+
+    Problem(std::istream& stream, ElementsF elements_f, ElementsG elements_g, const int nb_threads, const int grainsize)
+        : m_id(s_next_id++)
+        , m_sigma(1.0)
+        , m_nb_threads(nb_threads)
+        , m_grainsize(grainsize)
+        , m_elements_f(std::move(elements_f))
+        , m_elements_g(std::move(elements_g))
+        , m_active_elements_f(length(m_elements_f))
+        , m_active_elements_g(length(m_elements_g))
+        , m_max_element_n(0)
+        , m_max_element_m(0)
+        , m_hm_constant_valid(false)
+        , m_cached_order(-1)
+        , m_owns_variables(false)
+    {
+        Log::task_begin("Load problem...");
+
+        Timer timer;
+
+        Trace::Span span("Problem::load");
+
+        const auto nb_elements_f = length(m_elements_f);
+        const auto nb_elements_g = length(m_elements_g);
+
+        initialize_element_sizes();
+
+        Log::task_step("Read header...");
+        Trace::Span phase("read header");
+
+        std::uint64_t magic;
+        std::uint64_t version;
+        std::uint64_t checksum;
+
+        binary_file::read(stream, magic);
+
+        if (magic != s_file_magic) {
+            throw std::runtime_error("The file does not contain a problem");
+        }
+
+        binary_file::read(stream, version);
+
+        if (version != s_file_version) {
+            throw std::runtime_error(format("Unsupported file version {}", version));
+        }
+
+        binary_file::read(stream, checksum);
+
+        if (checksum != element_checksum()) {
+            throw std::runtime_error("The file was saved for a different set of elements");
+        }
+
+        std::int64_t n;
+        std::int64_t m;
+
+        binary_file::read(stream, n);
+        binary_file::read(stream, m);
+
+        Log::task_step("Read element indices...");
+        phase.step("read element indices");
+
+        m_element_f_variable_indices.read(stream);
+        m_element_g_equation_indices.read(stream);
+        m_element_g_variable_indices.read(stream);
+
+        if (m_element_f_variable_indices.nb_elements() != nb_elements_f || m_element_g_equation_indices.nb_elements() != nb_elements_g || m_element_g_variable_indices.nb_elements() != nb_elements_g) {
+            throw std::runtime_error("The file was saved for a different set of elements");
+        }
+
+        m_node_locations.read(stream, m_elements_f);
+
+        Log::task_step("Restore equations and variables...");
+        phase.step("restore items");
+
+        m_equations.resize(m);
+        m_variables.resize(n);
+
+        for (index i = 0; i < nb_elements_g; i++) {
+            restore_items(m_elements_g[i]->equations(), m_element_g_equation_indices[i], m_equations);
+        }
+
+        for (index i = 0; i < nb_elements_f; i++) {
+            restore_items(m_elements_f[i]->variables(), m_element_f_variable_indices[i], m_variables);
+        }
+
+        for (index i = 0; i < nb_elements_g; i++) {
+            restore_items(m_elements_g[i]->variables(), m_element_g_variable_indices[i], m_variables);
+        }
+
+        for (index i = 0; i < m; i++) {
+            m_equations[i]->set_slot(m_id, i);
+        }
+
+        for (index i = 0; i < n; i++) {
+            m_variables[i]->set_slot(m_id, i);
+        }
+
+        // an item stored at two indices keeps only the last slot
+
+        for (index i = 0; i < m; i++) {
+            if (m_equations[i]->slot_index() != i) {
+                throw std::runtime_error("The elements do not match the saved problem");
+            }
+        }
+
+        for (index i = 0; i < n; i++) {
+            if (m_variables[i]->slot_index() != i) {
+                throw std::runtime_error("The elements do not match the saved problem");
+            }
+        }
+
+        assign_node_variables();
+
+        initialize_batches();
+
+        Log::task_info("The problem contains {} variables", n);
+        Log::task_info("The problem contains {} constraint equations", m);
+
+        Log::task_step("Read sparse structures...");
+        phase.step("read sparse structures");
+
+        m_structure_dg = read_structure(stream);
+        m_structure_hm = read_structure(stream);
+
+        if (m_structure_dg.rows() != m || m_structure_dg.cols() != n || m_structure_hm.rows() != n || m_structure_hm.cols() != n) {
+            throw std::runtime_error("The sparse structures do not match the problem");
+        }
+
+        Log::task_step("Allocate memory...");
+        phase.step("allocate memory");
+
+        m_data.resize(n, m, m_structure_dg.nb_nonzeros(), m_structure_hm.nb_nonzeros(), m_max_element_n, m_max_element_m);
+
+        #ifdef EQLIB_USE_MKL
+        m_linear_solver = new_<PardisoLDLT>();
+        #else
+        m_linear_solver = new_<SimplicialLDLT>();
+        #endif
+
+        Log::task_end("Problem loaded in {:.3f} sec", timer.ellapsed());
+    }
+
+public: // constructors
+    ~Problem()
+    {
+        // the worker might need the GIL to compute python elements
+
+        if (Py_IsInitialized() && PyGILState_Check()) {
+            pybind11::gil_scoped_release release;
+            wait();
+        } else {
+            wait();
+        }
+
+        set_owns_variables(false);
+    }
+
+private: // methods: setup
+    void initialize_element_sizes()
+    {
+        const auto nb_elements_f = length(m_elements_f);
+        const auto nb_elements_g = length(m_elements_g);
+
+        m_element_f_nb_variables.resize(nb_elements_f);
+        m_element_g_nb_variables.resize(nb_elements_g);
+        m_element_g_nb_equations.resize(nb_elements_g);
+
+        for (index i = 0; i < nb_elements_f; i++) {
+            const auto& element = *m_elements_f[i];
+
+            const index nb_variables = element.nb_variables();
+
+            m_element_f_nb_variables[i] = nb_variables;
+            m_max_element_n = std::max(m_max_element_n, nb_variables);
+        }
+
+        for (index i = 0; i < nb_elements_g; i++) {
+            const auto& element = *m_elements_g[i];
+
+            const index nb_equations = element.nb_equations();
+            const index nb_variables = element.nb_variables();
+
+            m_element_g_nb_variables[i] = nb_variables;
+            m_element_g_nb_equations[i] = nb_equations;
+
+            m_max_element_n = std::max(m_max_element_n, nb_variables);
+            m_max_element_m = std::max(m_max_element_m, nb_equations);
+        }
+    }
+
+    // appends the active items of the elements to result in the order of
+    // their first occurrence. In parallel, each thread removes the duplicates
+    // within its contiguous block of elements by sorting the raw pointers, so
+    // only the remaining candidates are checked serially
+
+    template <typename T, typename TItemsOf>
+    void collect_unique(const index nb_elements, TItemsOf&& items_of, std::vector<Pointer<T>>& result)
+    {
+        const auto add = [&](const Pointer<T>& item) {
+            if (!item->is_active() || item->slot_problem() == m_id) {
+                return;
+            }
+
+            item->set_slot(m_id, length(result));
+            result.push_back(item);
+        };
+
+        if (m_nb_threads == 1) {
+            for (index i = 0; i < nb_elements; i++) {
+                for (const auto& item : items_of(i)) {
+                    add(item);
+                }
+            }
+
+            return;
+        }
+
+        struct Candidate {
+            const T* key;
+            index order;
+            const Pointer<T>* item;
+        };
+
+        std::vector<std::vector<Candidate>> candidates;
+
+        #pragma omp parallel num_threads(m_nb_threads)
+        {
+            #pragma omp single
+            candidates.resize(omp_get_num_threads());
+
+            auto& local = candidates[omp_get_thread_num()];
+
+            // a static schedule assigns the blocks in the order of the threads
+
+            #pragma omp for schedule(static)
+            for (index i = 0; i < nb_elements; i++) {
+                for (const auto& item : items_of(i)) {
+                    if (item->is_active()) {
+                        local.push_back({item.get(), length(local), &item});
+                    }
+                }
+            }
+
+            std::sort(local.begin(), local.end(), [](const Candidate& a, const Candidate& b) {
+                return std::less<const T*>()(a.key, b.key) || (a.key == b.key && a.order < b.order);
+            });
+
+            local.erase(std::unique(local.begin(), local.end(), [](const Candidate& a, const Candidate& b) {
+                return a.key == b.key;
+            }), local.end());
+
+            std::sort(local.begin(), local.end(), [](const Candidate& a, const Candidate& b) {
+                return a.order < b.order;
+            });
+        }
+
+        for (const auto& local : candidates) {
+            for (const auto& candidate : local) {
+                add(*candidate.item);
+            }
+        }
+    }
+
+    // inactive variables are not part of the problem, so their values are
+    // gathered through the nodes
+
+    void assign_node_variables()
+    {
+        m_node_locations.assign_variables([&](const Pointer<Variable>& variable) -> index {
+            return variable->is_active() ? variable_index(variable) : -1;
+        });
+    }
+
+    void initialize_batches()
+    {
+        std::set<const BatchObjective::Batch*> batches;
+
+        for (const auto& element : m_elements_f) {
+            const auto batch_element = dynamic_cast<const BatchObjective::Element*>(element.get());
+
+            if (batch_element != nullptr && batches.insert(batch_element->batch().get()).second) {
+                m_batches.push_back(batch_element->batch());
+            }
+        }
+    }
+
+private: // methods: file
+    // fingerprint of the number of elements and their sizes. The items
+    // themselves are checked while they are restored
+
+    std::uint64_t element_checksum() const noexcept
+    {
+        std::uint64_t hash = 14'695'981'039'346'656'037ull;
+
+        const auto add = [&](const index value) {
+            hash = (hash ^ static_cast<std::uint64_t>(value)) * 1'099'511'628'211ull;
+        };
+
+        add(length(m_elements_f));
+        add(length(m_elements_g));
+
+        for (const auto nb_variables : m_element_f_nb_variables) {
+            add(nb_variables);
+        }
+
+        for (index i = 0; i < length(m_elements_g); i++) {
+            add(m_element_g_nb_equations[i]);
+            add(m_element_g_nb_variables[i]);
+        }
+
+        return hash;
+    }
+
+    // puts the active items of an element at their saved global indices
+
+    template <typename T>
+    static void restore_items(const std::vector<Pointer<T>>& items, const ElementIndices::Range& entries, std::vector<Pointer<T>>& result)
+    {
+        if (count_active(items) != length(entries)) {
+            throw std::runtime_error("The elements do not match the saved problem");
+        }
+
+        for (const auto entry : entries) {
+            if (entry.local < 0 || entry.local >= length(items) || entry.global < 0 || entry.global >= length(result)) {
+                throw std::runtime_error("The elements do not match the saved problem");
+            }
+
+            const auto& item = items[entry.local];
+
+            if (!item->is_active() || (result[entry.global] != nullptr && result[entry.global] != item)) {
+                throw std::runtime_error("The elements do not match the saved problem");
+            }
+
+            result[entry.global] = item;
+        }
+    }
+
+    static void write_structure(std::ostream& stream, const SparseStructure<double, int, true>& structure)
+    {
+        binary_file::write(stream, static_cast<std::int64_t>(structure.rows()));
+        binary_file::write(stream, static_cast<std::int64_t>(structure.cols()));
+        binary_file::write(stream, structure.ia());
+        binary_file::write(stream, structure.ja());
+    }
+
+    static SparseStructure<double, int, true> read_structure(std::istream& stream)
+    {
+        std::int64_t rows;
+        std::int64_t cols;
+        std::vector<int> ia;
+        std::vector<int> ja;
+
+        binary_file::read(stream, rows);
+        binary_file::read(stream, cols);
+        binary_file::read(stream, ia);
+        binary_file::read(stream, ja);
+
+        return SparseStructure<double, int, true>(static_cast<int>(rows), static_cast<int>(cols), ia, ja);
+    }
+
+public: // methods: file
+    // writes the ordering of the equations and variables, the element
+    // indices and the sparse structures. Values are not stored
+
+    void save(const std::string& path) const
+    {
+        std::ofstream stream(path, std::ios::binary);
+
+        if (!stream) {
+            throw std::runtime_error(format("Could not open '{}'", path));
+        }
+
+        binary_file::write(stream, s_file_magic);
+        binary_file::write(stream, s_file_version);
+        binary_file::write(stream, element_checksum());
+        binary_file::write(stream, static_cast<std::int64_t>(nb_variables()));
+        binary_file::write(stream, static_cast<std::int64_t>(nb_equations()));
+
+        m_element_f_variable_indices.write(stream);
+        m_element_g_equation_indices.write(stream);
+        m_element_g_variable_indices.write(stream);
+
+        m_node_locations.write(stream);
+
+        write_structure(stream, m_structure_dg);
+        write_structure(stream, m_structure_hm);
+
+        if (!stream) {
+            throw std::runtime_error(format("Could not write '{}'", path));
+        }
+    }
+
+    // creates a problem from the same elements as the saved one without
+    // analysing them again
 
-        Log::task_step("Initialize linear solver...");
+    static Pointer<Problem> load(const std::string& path, ElementsF elements_f, ElementsG elements_g, const int nb_threads = 1, const int grainsize = 100)
+    {
+        std::ifstream stream(path, std::ios::binary);
 
-        #ifdef EQLIB_USE_MKL
-        m_linear_solver = new_<PardisoLDLT>();
-        #else
-        m_linear_solver = new_<SimplicialLDLT>();
-        #endif
+        if (!stream) {
+            throw std::runtime_error(format("Could not open '{}'", path));
+        }
 
-        Log::task_step("Initialize element boundaries...");
+        return Pointer<Problem>(new Problem(stream, std::move(elements_f), std::move(elements_g), nb_threads, grainsize));
+    }
 
-        m_element_f_variable_indices_hi.resize(nb_elements_f);
+private: // methods: index lookup
+    template <typename T>
+    static index count_active(const std::vector<Pointer<T>>& items)
+    {
+        index result = 0;
 
-        for (index i = 0; i < nb_elements_f; i++)
-        {
-            const auto& element_indices = m_element_f_variable_indices[i];
+        for (const auto& item : items) {
+            if (item->is_active()) {
+                result += 1;
+            }
+        }
 
-            std::vector<index> element_hi(length(element_indices));
+        return result;
+    }
 
-            for (index row_i = 0; row_i < length(element_indices); row_i++) {
-                const auto row = element_indices[row_i];
-                const auto col = element_indices.back();
+    template <typename T>
+    static Pointer<DenseMap<const T*, index>> create_index_lookup(const std::vector<Pointer<T>>& items)
+    {
+        auto lookup = std::make_shared<DenseMap<const T*, index>>();
 
-                element_hi[row_i] = m_structure_hm.get_index(row.global, col.global) + 1;
-            }
+        lookup->set_empty_key(nullptr);
+        lookup->resize(items.size());
 
-            m_element_f_variable_indices_hi[i] = std::move(element_hi);
+        for (index i = 0; i < length(items); i++) {
+            (*lookup)[items[i].get()] = i;
         }
 
-        Log::task_end("Problem initialized in {:.3f} sec", timer.ellapsed());
+        return lookup;
     }
 
 private: // methods: computation
@@ -452,12 +895,23 @@ private: // methods: computation
             return;
         }
 
-        const auto& variable_indices = m_element_f_variable_indices[i];
+        // the cached hessian is added by compute
+
+        if constexpr (TOrder == 2) {
+            if (m_hm_constant_valid && element_f.has_constant_hessian()) {
+                compute_element_f<1>(data, i);
+                return;
+            }
+        }
+
+        const auto variable_indices = m_element_f_variable_indices[i];
 
         if (variable_indices.empty()) {
             return;
         }
 
+        const auto variable_indices_hi = m_element_f_variable_indices.hm_offsets(i);
+
         const auto n = m_element_f_nb_variables[i];
 
         index size_g = TOrder > 0 ? n : 0;
@@ -468,7 +922,7 @@ private: // methods: computation
 
         Timer timer_element_compute;
 
-        const double f = element_f.compute(g, h);
+        const double f = element_f.compute_gathered(g, h, m_node_locations.view(i));
 
         data.computation_time() += timer_element_compute.ellapsed();
 
@@ -482,7 +936,7 @@ private: // methods: computation
             data.df(row.global) += g(row.local);
 
             auto lo = m_structure_hm.get_first_index(row.global);
-            const auto hi = m_element_f_variable_indices_hi[i][row_i];
+            const index hi = variable_indices_hi[row_i];
 
             for (index col_i = row_i; col_i < length(variable_indices) && TOrder > 1; col_i++) {
                 const auto col = variable_indices[col_i];
@@ -513,8 +967,8 @@ private: // methods: computation
             return;
         }
 
-        const auto& equation_indices = m_element_g_equation_indices[i];
-        const auto& variable_indices = m_element_g_variable_indices[i];
+        const auto equation_indices = m_element_g_equation_indices[i];
+        const auto variable_indices = m_element_g_variable_indices[i];
 
         if (equation_indices.empty() || variable_indices.empty()) {
             return;
@@ -605,6 +1059,61 @@ public: // methods: computation
         }
     }
 
+    // computes the hessian of the active objectives with a constant hessian
+    // if this set or the revision of one of them has changed since the last
+    // call
+
+    void update_constant_hessian()
+    {
+        std::vector<index> constant_elements_f;
+        std::vector<index> constant_revisions_f;
+
+        for (const index i : m_active_elements_f) {
+            if (m_elements_f[i]->has_constant_hessian()) {
+                constant_elements_f.emplace_back(i);
+                constant_revisions_f.emplace_back(m_elements_f[i]->revision());
+            }
+        }
+
+        if (m_hm_constant_valid && constant_elements_f == m_constant_elements_f && constant_revisions_f == m_constant_revisions_f) {
+            return;
+        }
+
+        m_hm_constant_valid = false;
+
+        m_constant_elements_f = std::move(constant_elements_f);
+        m_constant_revisions_f = std::move(constant_revisions_f);
+
+        if (m_constant_elements_f.empty()) {
+            m_hm_constant.resize(0);
+            return;
+        }
+
+        ProblemData data(m_data);
+
+        data.set_zero<2>();
+
+        for (const index i : m_constant_elements_f) {
+            compute_element_f<2>(data, i);
+        }
+
+        m_hm_constant = data.hm();
+
+        m_hm_constant_valid = true;
+    }
+
+    // has to be called if the hessian of an objective with a constant hessian
+    // has changed without a new revision, e.g. for python objectives
+
+    void invalidate_constant_hessian()
+    {
+        check_idle();
+
+        m_hm_constant_valid = false;
+        m_constant_elements_f.clear();
+        m_constant_revisions_f.clear();
+    }
+
     template <bool TParallel, bool TInfo, index TOrder>
     void compute()
     {
@@ -616,15 +1125,43 @@ public: // methods: computation
 
         Timer timer;
 
+        Trace::Span span("Problem::compute");
+
+        invalidate_cache();
+
         m_data.set_zero<TOrder>();
 
         update_active_elements();
 
+        if (!m_node_locations.empty()) {
+            Trace::Span gather_span("gather nodes");
+
+            if (m_owns_variables) {
+                m_node_locations.gather(m_variable_values);
+            } else {
+                m_node_locations.gather();
+            }
+        }
+
+        if (!m_batches.empty()) {
+            Trace::Span batch_span("batches");
+
+            for (const auto& batch : m_batches) {
+                batch->compute(TOrder);
+            }
+        }
+
+        if constexpr (TOrder > 1) {
+            update_constant_hessian();
+        }
+
         if constexpr (TParallel) {
             ProblemData l_data(m_data);
 
             #pragma omp parallel if (m_nb_threads != 1) num_threads(m_nb_threads) firstprivate(l_data)
             {
+                Trace::Span thread_span("assemble");
+
                 #pragma omp for schedule(dynamic, m_grainsize) nowait
                 for (index i = 0; i < nb_elements_f(); i++) {
                     compute_element_f<TOrder>(l_data, i);
@@ -647,10 +1184,14 @@ public: // methods: computation
                     compute_element_g<TOrder>(l_data, i);
                 }
 
+                thread_span.step("reduce");
+
                 #pragma omp critical
                 m_data += l_data;
             }
         } else {
+            Trace::Span assemble_span("assemble");
+
             for (index i = 0; i < nb_elements_f(); i++) {
                 compute_element_f<TOrder>(m_data, i);
             }
@@ -672,6 +1213,12 @@ public: // methods: computation
             }
         }
 
+        if constexpr (TOrder > 1) {
+            if (m_hm_constant_valid) {
+                m_data.hm() += sigma() * m_hm_constant;
+            }
+        }
+
         if constexpr (TInfo) {
             Log::task_info("Element computation took {} sec", m_data.computation_time());
             Log::task_info("Assembly of the system took {} sec", m_data.assemble_time());
@@ -693,6 +1240,8 @@ public: // methods: computation
     template <bool TInfo>
     void compute(const index order = 2)
     {
+        check_idle();
+
         if (m_nb_threads == 1) {
             switch (order) {
             case 0:
@@ -726,6 +1275,8 @@ public: // methods: computation
 
     void compute(const index order = 2)
     {
+        check_idle();
+
         if (m_nb_threads == 1) {
             switch (order) {
             case 0:
@@ -757,17 +1308,144 @@ public: // methods: computation
         }
     }
 
-public: // methods
-    Vector hm_inv_v(Ref<const Vector> v)
+public: // methods: cached computation
+    // computes the problem at x unless the results of the last call are still
+    // valid for this point and at least the requested order. Used by the
+    // scipy-style *_of methods, which are often called with the same x
+
+    void compute_at(Ref<const Vector> x, const index order)
+    {
+        if (order < 0 || order > 2) {
+            throw std::invalid_argument("order");
+        }
+
+        check_idle();
+
+        if (is_cached(x, order)) {
+            return;
+        }
+
+        set_x(x);
+
+        compute<false>(order);
+
+        m_cached_x = x;
+        m_cached_equation_multipliers = equation_multipliers();
+        m_cached_sigma = sigma();
+        m_cached_order = order;
+    }
+
+    bool is_cached(Ref<const Vector> x, const index order) const
+    {
+        if (order > m_cached_order || sigma() != m_cached_sigma) {
+            return false;
+        }
+
+        // Eigen requires equal sizes for the comparison
+
+        if (length(x) != nb_variables() || length(m_cached_x) != nb_variables() || length(m_cached_equation_multipliers) != nb_equations()) {
+            return false;
+        }
+
+        // the variables might have been changed from outside
+
+        return x == m_cached_x && this->x() == m_cached_x && equation_multipliers() == m_cached_equation_multipliers;
+    }
+
+    // has to be called if the results of compute_at are no longer valid for
+    // other reasons than a change of x, e.g. after activating elements
+
+    void invalidate_cache() noexcept
+    {
+        m_cached_order = -1;
+    }
+
+public: // methods: asynchronous computation
+    // the asynchronous methods run on a worker thread and return immediately.
+    // While an operation is pending, the methods which compute the problem or
+    // change its input throw a runtime_error. The results must not be used
+    // before the operation is finished
+
+    bool is_busy() const
+    {
+        const auto is_pending = [](const auto& future) {
+            return future.valid() && future.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+        };
+
+        return is_pending(m_pending_compute) || is_pending(m_pending_hm_inv_v);
+    }
+
+    void check_idle() const
+    {
+        if (is_busy()) {
+            throw std::runtime_error("The problem is busy with an asynchronous operation");
+        }
+    }
+
+    void wait() const
+    {
+        if (m_pending_compute.valid()) {
+            m_pending_compute.wait();
+        }
+
+        if (m_pending_hm_inv_v.valid()) {
+            m_pending_hm_inv_v.wait();
+        }
+    }
+
+    std::shared_future<void> compute_async(const index order = 2)
+    {
+        if (order < 0 || order > 2) {
+            throw std::invalid_argument("order");
+        }
+
+        check_idle();
+
+        invalidate_cache();
+
+        m_pending_compute = std::async(std::launch::async, [this, order]() {
+            switch (order) {
+            case 0:
+                compute<true, 0>();
+                break;
+            case 1:
+                compute<true, 1>();
+                break;
+            default:
+                compute<true, 2>();
+                break;
+            }
+        }).share();
+
+        return m_pending_compute;
+    }
+
+    std::shared_future<Vector> hm_inv_v_async(Ref<const Vector> v)
+    {
+        check_idle();
+
+        m_pending_hm_inv_v = std::async(std::launch::async, [this, v = Vector(v)]() {
+            return solve_hm(v);
+        }).share();
+
+        return m_pending_hm_inv_v;
+    }
+
+private: // methods
+    Vector solve_hm(Ref<const Vector> v)
     {
         if (nb_variables() == 0) {
             return Vector(0);
         }
 
+        Trace::Span span("factorize");
+
         if (m_linear_solver->factorize(m_structure_hm.ia(), m_structure_hm.ja(), m_data.hm())) {
             throw std::runtime_error("Factorization failed");
         }
 
+        span.step("solve");
+
         Vector x(nb_variables());
 
         if (m_linear_solver->solve(m_structure_hm.ia(), m_structure_hm.ja(), m_data.hm(), v, x)) {
@@ -777,6 +1455,14 @@ public: // methods
         return x;
     }
 
+public: // methods
+    Vector hm_inv_v(Ref<const Vector> v)
+    {
+        check_idle();
+
+        return solve_hm(v);
+    }
+
     Vector hm_v(Ref<const Vector> v) const
     {
         return hm().selfadjointView<Eigen::Upper>() * v.transpose();
@@ -796,6 +1482,10 @@ public: // methods
 
     void set_hm_diagonal(Eigen::Ref<const Vector> value)
     {
+        check_idle();
+
+        invalidate_cache();
+
         for (int row = 0; row < nb_variables(); row++) {
             const int i = m_structure_hm.ia(row);
             hm(i) = value(row);
@@ -804,6 +1494,10 @@ public: // methods
 
     void hm_add_diagonal(const double value)
     {
+        check_idle();
+
+        invalidate_cache();
+
         for (int row = 0; row < nb_variables(); row++) {
             const int i = m_structure_hm.ia(row);
             hm(i) += value;
@@ -833,6 +1527,10 @@ public: // methods
 
     void scale(const double factor)
     {
+        check_idle();
+
+        invalidate_cache();
+
         m_data.values() *= factor;
     }
 
@@ -840,6 +1538,18 @@ public: // methods
     {
         auto new_problem = new_<Problem>(*this);
 
+        // the variables stay bound to this problem
+
+        new_problem->m_owns_variables = false;
+        new_problem->m_variable_values.resize(0);
+        new_problem->m_variable_lower_bounds.resize(0);
+        new_problem->m_variable_upper_bounds.resize(0);
+        new_problem->m_variable_multiplier_values.resize(0);
+        new_problem->m_variable_storage = VariableStorage();
+
+        new_problem->m_pending_compute = {};
+        new_problem->m_pending_hm_inv_v = {};
+
 #ifdef EQLIB_USE_MKL
         new_problem->m_linear_solver = new_<PardisoLDLT>();
 #else
@@ -856,66 +1566,50 @@ public: // methods
 
     void remove_inactive_objectives()
     {
-        index nb_active_elements_f = 0;
-
-        for (const auto& element : m_elements_f) {
-            if (element->is_active()) {
-                nb_active_elements_f += 1;
-            }
-        }
-
-        ElementsF elements_f(nb_active_elements_f);
-
-        std::vector<index> element_f_nb_variables(nb_active_elements_f);
+        check_idle();
 
-        std::vector<std::vector<Index>> element_f_variable_indices(nb_active_elements_f);
+        std::vector<bool> mask(m_elements_f.size());
 
         index max_element_n = 0;
 
         index j = 0;
 
         for (index i = 0; i < length(m_elements_f); i++) {
-            if (!m_elements_f[i]->is_active()) {
+            mask[i] = m_elements_f[i]->is_active();
+
+            if (!mask[i]) {
                 continue;
             }
 
             max_element_n = std::max(max_element_n, m_elements_f[i]->nb_variables());
 
-            element_f_nb_variables[j] = m_element_f_nb_variables[i];
-
-            element_f_variable_indices[j] = std::move(m_element_f_variable_indices[i]);
+            m_element_f_nb_variables[j] = m_element_f_nb_variables[i];
 
-            elements_f[j] = std::move(m_elements_f[i]);
+            m_elements_f[j] = std::move(m_elements_f[i]);
 
             j += 1;
         }
 
         m_max_element_n = max_element_n;
 
-        m_element_f_nb_variables = std::move(element_f_nb_variables);
+        m_element_f_nb_variables.resize(j);
 
-        m_element_f_variable_indices = std::move(element_f_variable_indices);
+        m_element_f_variable_indices.compact(mask);
 
-        m_elements_f = std::move(elements_f);
-    }
+        m_elements_f.resize(j);
 
-    void remove_inactive_constraints()
-    {
-        index nb_active_elements_g = 0;
+        m_node_locations.initialize(m_elements_f);
 
-        for (const auto& element : m_elements_g) {
-            if (element->is_active()) {
-                nb_active_elements_g += 1;
-            }
-        }
+        assign_node_variables();
 
-        ElementsG elements_g(nb_active_elements_g);
+        invalidate_constant_hessian();
+    }
 
-        std::vector<index> element_g_nb_variables(nb_active_elements_g);
-        std::vector<index> element_g_nb_equations(nb_active_elements_g);
+    void remove_inactive_constraints()
+    {
+        check_idle();
 
-        std::vector<std::vector<Index>> element_g_equation_indices(nb_active_elements_g);
-        std::vector<std::vector<Index>> element_g_variable_indices(nb_active_elements_g);
+        std::vector<bool> mask(m_elements_g.size());
 
         index max_element_n = 0;
         index max_element_m = 0;
@@ -923,20 +1617,19 @@ public: // methods
         index j = 0;
 
         for (index i = 0; i < length(m_elements_g); i++) {
-            if (!m_elements_g[i]->is_active()) {
+            mask[i] = m_elements_g[i]->is_active();
+
+            if (!mask[i]) {
                 continue;
             }
 
             max_element_n = std::max(max_element_n, m_elements_g[i]->nb_variables());
             max_element_m = std::max(max_element_m, m_elements_g[i]->nb_equations());
 
-            element_g_nb_variables[j] = element_g_nb_variables[i];
-
-            element_g_nb_equations[j] = element_g_nb_equations[i];
-            element_g_variable_indices[j] = std::move(element_g_variable_indices[i]);
-            element_g_equation_indices[j] = std::move(element_g_equation_indices[i]);
+            m_element_g_nb_variables[j] = m_element_g_nb_variables[i];
+            m_element_g_nb_equations[j] = m_element_g_nb_equations[i];
 
-            elements_g[j] = std::move(m_elements_g[i]);
+            m_elements_g[j] = std::move(m_elements_g[i]);
 
             j += 1;
         }
@@ -944,17 +1637,19 @@ public: // methods
         m_max_element_n = max_element_n;
         m_max_element_m = max_element_m;
 
-        m_element_g_nb_equations = std::move(element_g_nb_equations);
-        m_element_g_nb_variables = std::move(element_g_nb_variables);
+        m_element_g_nb_equations.resize(j);
+        m_element_g_nb_variables.resize(j);
 
-        m_element_g_equation_indices = std::move(element_g_equation_indices);
-        m_element_g_variable_indices = std::move(element_g_variable_indices);
+        m_element_g_equation_indices.compact(mask);
+        m_element_g_variable_indices.compact(mask);
 
-        m_elements_g = std::move(elements_g);
+        m_elements_g.resize(j);
     }
 
     void remove_inactive_elements()
     {
+        check_idle();
+
         remove_inactive_objectives();
         remove_inactive_constraints();
     }
@@ -967,6 +1662,8 @@ public: // methods: model properties
 
     void set_linear_solver(const Pointer<LinearSolver> value)
     {
+        check_idle();
+
         if (value == nullptr) {
             throw std::invalid_argument("Value is null");
         }
@@ -979,8 +1676,10 @@ public: // methods: model properties
         return m_nb_threads;
     }
 
-    void set_nb_threads(const int value) noexcept
+    void set_nb_threads(const int value)
     {
+        check_idle();
+
         m_nb_threads = value;
     }
 
@@ -989,8 +1688,10 @@ public: // methods: model properties
         return m_grainsize;
     }
 
-    void set_grainsize(const int value) noexcept
+    void set_grainsize(const int value)
     {
+        check_idle();
+
         m_grainsize = value;
     }
 
@@ -1036,9 +1737,18 @@ public: // methods: model properties
 
     index variable_index(const Pointer<Variable>& variable) const
     {
-        const auto it = m_variable_indices.find(variable);
+        if (variable->slot_problem() == m_id) {
+            return variable->slot_index();
+        }
+
+        #pragma omp critical(eqlib_problem_index_lookup)
+        if (!m_variable_indices) {
+            m_variable_indices = create_index_lookup<Variable>(m_variables);
+        }
+
+        const auto it = m_variable_indices->find(variable.get());
 
-        if (it == m_variable_indices.end()) {
+        if (it == m_variable_indices->end()) {
             return -1;
         }
 
@@ -1052,18 +1762,83 @@ public: // methods: model properties
 
     index equation_index(const Pointer<Equation>& equation) const
     {
-        const auto it = m_equation_indices.find(equation);
+        if (equation->slot_problem() == m_id) {
+            return equation->slot_index();
+        }
+
+        #pragma omp critical(eqlib_problem_index_lookup)
+        if (!m_equation_indices) {
+            m_equation_indices = create_index_lookup<Equation>(m_equations);
+        }
+
+        const auto it = m_equation_indices->find(equation.get());
 
-        if (it == m_equation_indices.end()) {
+        if (it == m_equation_indices->end()) {
             return -1;
         }
 
         return it->second;
     }
 
+public: // methods: variable storage
+    bool owns_variables() const noexcept
+    {
+        return m_owns_variables;
+    }
+
+    // binds the variables to contiguous arrays owned by the problem. The
+    // variables get their state back when the problem releases them
+
+    void set_owns_variables(const bool value)
+    {
+        check_idle();
+
+        if (value == m_owns_variables) {
+            return;
+        }
+
+        const index n = nb_variables();
+
+        if (value) {
+            for (const auto& variable : m_variables) {
+                if (variable->is_bound()) {
+                    throw std::runtime_error("A variable is already owned by another problem");
+                }
+            }
+
+            m_variable_values.resize(n);
+            m_variable_lower_bounds.resize(n);
+            m_variable_upper_bounds.resize(n);
+            m_variable_multiplier_values.resize(n);
+
+            m_variable_storage = {m_variable_values.data(), m_variable_lower_bounds.data(), m_variable_upper_bounds.data(), m_variable_multiplier_values.data()};
+
+            for (index i = 0; i < n; i++) {
+                m_variables[i]->bind(&m_variable_storage, i);
+            }
+        } else {
+            for (index i = 0; i < n; i++) {
+                m_variables[i]->unbind();
+            }
+
+            m_variable_values.resize(0);
+            m_variable_lower_bounds.resize(0);
+            m_variable_upper_bounds.resize(0);
+            m_variable_multiplier_values.resize(0);
+
+            m_variable_storage = VariableStorage();
+        }
+
+        m_owns_variables = value;
+    }
+
 public: // methods: input
     Vector x() const
     {
+        if (m_owns_variables) {
+            return m_variable_values;
+        }
+
         Vector result(nb_variables());
 
         for (index i = 0; i < length(result); i++) {
@@ -1075,10 +1850,17 @@ public: // methods: input
 
     void set_x(Ref<const Vector> value) const
     {
+        check_idle();
+
         if (length(value) != nb_variables()) {
             throw std::runtime_error("Invalid size");
         }
 
+        if (m_owns_variables) {
+            m_variable_values = value;
+            return;
+        }
+
         for (index i = 0; i < length(value); i++) {
             variable(i)->set_value(value[i]);
         }
@@ -1091,10 +1873,17 @@ public: // methods: input
 
     void add_x(Ref<const Vector> delta) const
     {
+        check_idle();
+
         if (length(delta) != nb_variables()) {
             throw std::runtime_error("Invalid size");
         }
 
+        if (m_owns_variables) {
+            m_variable_values += delta;
+            return;
+        }
+
         for (index i = 0; i < length(delta); i++) {
             variable(i)->value() += delta[i];
         }
@@ -1107,10 +1896,17 @@ public: // methods: input
 
     void sub_x(Ref<const Vector> delta) const
     {
+        check_idle();
+
         if (length(delta) != nb_variables()) {
             throw std::runtime_error("Invalid size");
         }
 
+        if (m_owns_variables) {
+            m_variable_values -= delta;
+            return;
+        }
+
         for (index i = 0; i < length(delta); i++) {
             variable(i)->value() -= delta[i];
         }
@@ -1123,6 +1919,10 @@ public: // methods: input
 
     Vector variable_multipliers() const
     {
+        if (m_owns_variables) {
+            return m_variable_multiplier_values;
+        }
+
         Vector result(nb_variables());
 
         for (index i = 0; i < length(result); i++) {
@@ -1134,10 +1934,17 @@ public: // methods: input
 
     void set_variable_multipliers(Ref<const Vector> value) const
     {
+        check_idle();
+
         if (length(value) != nb_variables()) {
             throw std::runtime_error("Invalid size");
         }
 
+        if (m_owns_variables) {
+            m_variable_multiplier_values = value;
+            return;
+        }
+
         for (index i = 0; i < length(value); i++) {
             variable(i)->set_multiplier(value[i]);
         }
@@ -1161,6 +1968,8 @@ public: // methods: input
 
     void set_equation_multipliers(Ref<const Vector> value) const
     {
+        check_idle();
+
         if (length(value) != nb_equations()) {
             throw std::runtime_error("Invalid size");
         }
@@ -1180,8 +1989,10 @@ public: // methods: input
         return m_sigma;
     }
 
-    void set_sigma(const double value) noexcept
+    void set_sigma(const double value)
     {
+        check_idle();
+
         m_sigma = value;
     }
 
@@ -1224,8 +2035,12 @@ public: // methods: output f
         return m_data.f();
     }
 
-    void set_f(const double value) noexcept
+    void set_f(const double value)
     {
+        check_idle();
+
+        invalidate_cache();
+
         m_data.f() = value;
     }
 
@@ -1272,7 +2087,7 @@ public: // methods: output df
     }
 
 public: // methods: output dg
-    auto structure_dg() const
+    const SparseStructure<double, int, true>& structure_dg() const noexcept
     {
         return m_structure_dg;
     }
@@ -1325,7 +2140,7 @@ public: // methods: output dg
     }
 
 public: // methods: output hm
-    auto structure_hm() const
+    const SparseStructure<double, int, true>& structure_hm() const noexcept
     {
         return m_structure_hm;
     }
@@ -1391,32 +2206,51 @@ public: // methods: python
         py::object scipy_sparse = py::module::import("scipy.sparse");
         py::object csr_matrix = scipy_sparse.attr("csr_matrix");
 
+        using Structure = SparseStructure<double, int, true>;
+
+        // csr matrices of hm and dg. The matrices returned by hm, dg, hm_of
+        // and dg_of own a copy of the values. The matrices returned by
+        // hm_view and dg_view share the memory of the problem and show the
+        // results of every later computation
+
+        const auto sparse_matrix = [=](const std::string& name, const bool copy) {
+            return [=](py::object self) -> py::object {
+                const auto& problem = self.cast<const Type&>();
+
+                const index rows = name == "dg" ? problem.nb_equations() : problem.nb_variables();
+
+                return csr_matrix(
+                    py::make_tuple(self.attr((name + "_values").c_str()), self.attr((name + "_indices").c_str()), self.attr((name + "_indptr").c_str())),
+                    std::make_pair(rows, problem.nb_variables()),
+                    "copy"_a = copy);
+            };
+        };
+
+        const auto index_view = [](const std::vector<int>& (Type::*indices)() const noexcept) {
+            return [=](py::object self) {
+                return Structure::index_view((self.cast<const Type&>().*indices)(), self);
+            };
+        };
+
         py::class_<Type, Holder>(m, name.c_str())
             // constructors
             .def(py::init<ElementsF, ElementsG, int, int>(), "objective"_a = py::list(), "constraints"_a = py::list(),
                 "nb_threads"_a = 1, "grainsize"_a = 100, py::keep_alive<1, 2>(), py::keep_alive<1, 3>())
             // read-only properties
             .def_property_readonly("is_constrained", &Type::is_constrained)
+            .def_property_readonly("is_busy", &Type::is_busy)
             .def_property_readonly("equations", &Type::equations)
             .def_property_readonly("variables", &Type::variables)
             .def_property_readonly("g", py::overload_cast<>(&Type::g))
             .def_property_readonly("df", py::overload_cast<>(&Type::df))
-            .def_property_readonly("dg", [=](Type& self) {
-                return csr_matrix(
-                    std::make_tuple(self.dg_values(), self.dg_indices(), self.dg_indptr()),
-                    std::make_pair(self.nb_equations(), self.nb_variables()))
-                    .release();
-            })
+            .def_property_readonly("dg", sparse_matrix("dg", true))
+            .def_property_readonly("dg_view", sparse_matrix("dg", false))
             .def_property_readonly("structure_dg", &Type::structure_dg)
             .def_property_readonly("dg_values", py::overload_cast<>(&Type::dg_values))
-            .def_property_readonly("dg_indptr", &Type::dg_indptr)
-            .def_property_readonly("dg_indices", &Type::dg_indices)
-            .def_property_readonly("hm", [=](Type& self) {
-                return csr_matrix(
-                    std::make_tuple(self.hm_values(), self.hm_indices(), self.hm_indptr()),
-                    std::make_pair(self.nb_variables(), self.nb_variables()))
-                    .release();
-            })
+            .def_property_readonly("dg_indptr", index_view(&Type::dg_indptr))
+            .def_property_readonly("dg_indices", index_view(&Type::dg_indices))
+            .def_property_readonly("hm", sparse_matrix("hm", true))
+            .def_property_readonly("hm_view", sparse_matrix("hm", false))
             .def_property_readonly("general_hm", [=](Type& self) {
                 const auto [structure, values] = self.structure_hm().to_general(self.hm_values());
                 return csr_matrix(
@@ -1427,8 +2261,8 @@ public: // methods: python
             })
             .def_property_readonly("structure_hm", &Type::structure_hm)
             .def_property_readonly("hm_values", py::overload_cast<>(&Type::hm_values))
-            .def_property_readonly("hm_indptr", &Type::hm_indptr)
-            .def_property_readonly("hm_indices", &Type::hm_indices)
+            .def_property_readonly("hm_indptr", index_view(&Type::hm_indptr))
+            .def_property_readonly("hm_indices", index_view(&Type::hm_indices))
             .def_property_readonly("hm_norm_inf", &Type::hm_norm_inf)
             .def_property_readonly("nb_equations", &Type::nb_equations)
             .def_property_readonly("nb_variables", &Type::nb_variables)
@@ -1441,6 +2275,7 @@ public: // methods: python
             .def_property("linear_solver", &Type::linear_solver, &Type::set_linear_solver)
             .def_property("f", &Type::f, &Type::set_f)
             .def_property("nb_threads", &Type::nb_threads, &Type::set_nb_threads)
+            .def_property("owns_variables", &Type::owns_variables, &Type::set_owns_variables)
             .def_property("grainsize", &Type::grainsize, &Type::set_grainsize)
             .def_property("sigma", &Type::sigma, &Type::set_sigma)
             .def_property("hm_diagonal", &Type::hm_diagonal, &Type::set_hm_diagonal)
@@ -1453,53 +2288,68 @@ public: // methods: python
             .def("variable_index", &Type::variable_index, "variable"_a)
             .def("equation_index", &Type::equation_index, "equation"_a)
             .def("clone", &Type::clone)
+            .def("save", &Type::save, "path"_a)
+            .def_static("load", &Type::load, "path"_a, "objective"_a = py::list(), "constraints"_a = py::list(),
+                "nb_threads"_a = 1, "grainsize"_a = 100, py::keep_alive<0, 2>(), py::keep_alive<0, 3>())
             .def("remove_inactive_elements", &Type::remove_inactive_elements)
+            .def("invalidate_constant_hessian", &Type::invalidate_constant_hessian)
             .def("compute", &Type::compute<true>, "order"_a = 2, py::call_guard<py::gil_scoped_release>())
             .def("hm_add_diagonal", &Type::hm_add_diagonal, "value"_a)
             .def("hm_inv_v", &Type::hm_inv_v, py::call_guard<py::gil_scoped_release>())
+            .def("compute_async", [](Type& self, const index order) {
+                return Future(self.compute_async(order));
+            },
+                "order"_a = 2, py::keep_alive<0, 1>())
+            .def("hm_inv_v_async", [](Type& self, Ref<const Vector> v) {
+                return Future(self.hm_inv_v_async(v));
+            },
+                "v"_a, py::keep_alive<0, 1>())
+            .def("wait", &Type::wait, py::call_guard<py::gil_scoped_release>())
             .def("hm_v", &Type::hm_v)
             .def("f_of", [](Type& self, Ref<const Vector> x) {
-                self.set_x(x);
-                self.compute<false>(0);
+                self.compute_at(x, 0);
                 return self.f();
             },
                 "x"_a, py::call_guard<py::gil_scoped_release>())
             .def("g_of", [](Type& self, Ref<const Vector> x) {
-                self.set_x(x);
-                self.compute<false>(0);
+                self.compute_at(x, 0);
                 return Vector(self.g());
             },
                 "x"_a, py::call_guard<py::gil_scoped_release>())
             .def("df_of", [](Type& self, Ref<const Vector> x) {
-                self.set_x(x);
-                self.compute<false>(1);
+                self.compute_at(x, 1);
                 return Vector(self.df());
             },
                 "x"_a, py::call_guard<py::gil_scoped_release>())
-            .def("dg_of", [=](Type& self, Ref<const Vector> x) {
-                self.set_x(x);
-                self.compute<false>(1);
-                return csr_matrix(
-                    std::make_tuple(self.dg_values(), self.dg_indices(), self.dg_indptr()),
-                    std::make_pair(self.nb_equations(), self.nb_variables()))
-                    .release();
+            .def("fdf_of", [](Type& self, Ref<const Vector> x) {
+                self.compute_at(x, 1);
+                return std::make_tuple(self.f(), Vector(self.df()));
             },
                 "x"_a, py::call_guard<py::gil_scoped_release>())
-            .def("hm_of", [=](Type& self, Ref<const Vector> x) {
-                self.set_x(x);
-                self.compute<false>(2);
-                return csr_matrix(
-                    std::make_tuple(self.hm_values(), self.hm_indices(), self.hm_indptr()),
-                    std::make_pair(self.nb_variables(), self.nb_variables()))
-                    .release();
+            .def("dg_of", [=](py::object self, Ref<const Vector> x) {
+                auto& problem = self.cast<Type&>();
+                {
+                    py::gil_scoped_release release;
+                    problem.compute_at(x, 1);
+                }
+                return sparse_matrix("dg", true)(self);
             },
-                "x"_a, py::call_guard<py::gil_scoped_release>())
+                "x"_a)
+            .def("hm_of", [=](py::object self, Ref<const Vector> x) {
+                auto& problem = self.cast<Type&>();
+                {
+                    py::gil_scoped_release release;
+                    problem.compute_at(x, 2);
+                }
+                return sparse_matrix("hm", true)(self);
+            },
+                "x"_a)
             .def("hm_v_of", [=](Type& self, Ref<const Vector> x, Ref<const Vector> p) {
-                self.set_x(x);
-                self.compute<false>(2);
+                self.compute_at(x, 2);
                 return self.hm_v(p);
             },
                 "x"_a, "p"_a, py::call_guard<py::gil_scoped_release>())
+            .def("invalidate_cache", &Type::invalidate_cache)
             .def("scale", &Type::scale, "factor"_a);
     }
 };
@@ -64,7 +64,7 @@ public: // methods
     void set_zero()
     {
         if constexpr(TOrder == 0) {
-            m_values(0) = 0;
+            m_values.head(1 + m_m).setZero();
         }
         if constexpr(TOrder == 1) {
             m_values.head(1 + m_m + m_n).setZero();
@@ -69,6 +69,15 @@ public: // methods
         return !success;
     }
 
+    index nb_negative_pivots() const override
+    {
+        if (!m_is_analyzed) {
+            return -1;
+        }
+
+        return (m_solver.vectorD().array() < 0.0).count();
+    }
+
 public: // python
     template <typename TModule>
     static void register_python(TModule& m)
@@ -2,6 +2,8 @@
 
 #include "Define.h"
 
+#include <pybind11/numpy.h>
+
 #include <functional>
 #include <set>
 #include <vector>
@@ -351,6 +353,20 @@ public: // methods
     }
 
 public: // python
+    // read-only numpy array on the memory of the indices. The base object
+    // keeps the memory alive as long as the array exists
+
+    static pybind11::array_t<TIndex> index_view(const std::vector<TIndex>& indices, pybind11::handle base)
+    {
+        namespace py = pybind11;
+
+        py::array_t<TIndex> array(indices.size(), indices.data(), base);
+
+        py::detail::array_proxy(array.ptr())->flags &= ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+
+        return array;
+    }
+
     template <typename TModule>
     static void register_python(TModule& m, const std::string& name)
     {
@@ -375,8 +391,8 @@ public: // python
             .def_property_readonly("cols", &Type::cols)
             .def_property_readonly("nb_nonzeros", &Type::nb_nonzeros)
             .def_property_readonly("density", &Type::density)
-            .def_property_readonly("ia", py::overload_cast<>(&Type::ia, py::const_))
-            .def_property_readonly("ja", py::overload_cast<>(&Type::ja, py::const_));
+            .def_property_readonly("ia", [](py::object self) { return index_view(self.cast<const Type&>().ia(), self); })
+            .def_property_readonly("ja", [](py::object self) { return index_view(self.cast<const Type&>().ja(), self); });
     }
 };
 
@@ -6,7 +6,11 @@
 #include "Log.h"
 #include "Problem.h"
 #include "Settings.h"
+#include "Telemetry.h"
 #include "Timer.h"
+#include "Trace.h"
+
+#include <cmath>
 
 namespace eqlib {
 
@@ -28,16 +32,25 @@ private: // members
     double m_damping;
     index m_stopping_reason;
     Armijo m_linesearch;
+    Pointer<Telemetry> m_telemetry;
 
 private: // methods
 public: // constructor
     SteepestDecent(Pointer<Problem> problem)
         : m_problem(problem)
+        , m_iterations(0)
         , m_maxiter(100)
+        , m_fevals(0)
+        , m_gevals(0)
+        , m_hevals(0)
+        , m_rnorm(0.0)
+        , m_xnorm(0.0)
         , m_rtol(1e-6)
         , m_xtol(1e-6)
         , m_damping(0.0)
+        , m_stopping_reason(-1)
         , m_linesearch(problem)
+        , m_telemetry(new_<Telemetry>())
     {
         if (problem->is_constrained()) {
             throw std::runtime_error("Constraints are not supported");
@@ -110,6 +123,16 @@ public: // methods
         m_damping = value;
     }
 
+    index stopping_reason() const noexcept
+    {
+        return m_stopping_reason;
+    }
+
+    Pointer<Telemetry> telemetry() const noexcept
+    {
+        return m_telemetry;
+    }
+
     void run()
     {
         // setup
@@ -122,6 +145,13 @@ public: // methods
 
         Vector search_direction(n);
 
+        m_iterations = 0;
+        m_fevals = 0;
+        m_gevals = 0;
+        m_hevals = 0;
+
+        m_telemetry->begin(m_maxiter + 1);
+
         for (index iteration = 0;; iteration++) {
             // check max iterations
 
@@ -131,28 +161,37 @@ public: // methods
                 break;
             }
 
+            Trace::Span iteration_span("SteepestDecent iteration");
+
             Log::task_info("Iteration {}:", iteration + 1);
 
             // compute g
 
             Log::task_step("Computing system...");
 
+            Timer step_timer;
+
             m_problem->compute<false, 1>();
             m_gevals += 1;
 
-            Log::task_info("The current value is {}", m_problem->f());
+            double compute_time = step_timer.ellapsed();
+
+            const double f = m_problem->f();
+
+            Log::task_info("The current value is {}", f);
 
             // check residual
 
             Log::task_step("Computing residual...");
 
-            const double rnorm = m_problem->df().norm();
+            m_rnorm = m_problem->df().norm();
 
-            Log::task_info("The norm of the residual is {}", rnorm);
+            Log::task_info("The norm of the residual is {}", m_rnorm);
 
             // check residual norm
 
-            if (rnorm < m_rtol) {
+            if (m_rnorm < m_rtol) {
+                m_telemetry->record(f, m_rnorm, NAN, NAN, compute_time, 0.0, 0.0);
                 m_stopping_reason = 0;
                 Log::task_info("Stopped because rnorm < {}", m_rtol);
                 break;
@@ -162,21 +201,31 @@ public: // methods
 
             search_direction = -m_problem->df();
 
+            step_timer.start();
+
             const double alpha = m_linesearch.search(search_direction, 1.0, false);
 
+            compute_time += step_timer.ellapsed();
+
+            m_iterations = iteration + 1;
+
             // check x norm
 
-            const double xnorm = alpha * search_direction.norm();
+            m_xnorm = alpha * search_direction.norm();
 
-            Log::task_info("The norm of the step is {}", xnorm);
+            m_telemetry->record(f, m_rnorm, m_xnorm, alpha, compute_time, 0.0, 0.0);
 
-            if (xnorm < m_xtol) {
+            Log::task_info("The norm of the step is {}", m_xnorm);
+
+            if (m_xnorm < m_xtol) {
                 Log::task_info("Stopped because xnorm < {}", m_xtol);
                 m_stopping_reason = 1;
                 break;
             }
         }
 
+        m_telemetry->end();
+
         Log::task_end("System solved in {:.3f} sec", timer.ellapsed());
     }
 
@@ -194,9 +243,12 @@ public: // python
             .def_property("damping", &Type::damping, &Type::set_damping)
             .def_property("maxiter", &Type::maxiter, &Type::set_maxiter)
             .def_property("rtol", &Type::rtol, &Type::set_rtol)
+            .def_property("xtol", &Type::xtol, &Type::set_xtol)
             // read-only properties
             .def_property_readonly("iterations", &Type::iterations)
             .def_property_readonly("rnorm", &Type::rnorm)
+            .def_property_readonly("stopping_reason", &Type::stopping_reason)
+            .def_property_readonly("telemetry", &Type::telemetry)
             .def_property_readonly("fevals", &Type::fevals)
             .def_property_readonly("gevals", &Type::gevals)
             .def_property_readonly("hevals", &Type::hevals);
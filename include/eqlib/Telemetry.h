@@ -0,0 +1,255 @@
+#pragma once
+
+#include "Define.h"
+
+#include <pybind11/numpy.h>
+
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace eqlib {
+
+/*
+* Per-iteration history of a solver.
+*
+* The values are stored column by column in one buffer which is allocated by
+* `begin` for the maximum number of iterations. The columns are exposed to
+* Python as numpy arrays without copying. The arrays keep the buffer alive, so
+* they stay valid after the next run of the solver.
+*
+* If a path is set, every record is also written to that file as CSV or as
+* JSON lines.
+*/
+class Telemetry {
+private: // types
+    using Type = eqlib::Telemetry;
+    using Buffer = std::vector<double>;
+
+public: // types
+    enum Column : index {
+        F,
+        RNorm,
+        XNorm,
+        Alpha,
+        ComputeTime,
+        FactorizeTime,
+        SolveTime,
+        NbColumns
+    };
+
+private: // variables
+    Pointer<Buffer> m_buffer;
+    index m_capacity;
+    index m_size;
+    std::string m_path;
+    std::string m_format;
+    std::ofstream m_stream;
+
+    static inline const std::array<const char*, NbColumns> s_names = {
+        "f",
+        "rnorm",
+        "xnorm",
+        "alpha",
+        "compute_time",
+        "factorize_time",
+        "solve_time"
+    };
+
+private: // methods
+    void write_header()
+    {
+        if (m_format != "csv") {
+            return;
+        }
+
+        m_stream << "iteration";
+
+        for (const auto name : s_names) {
+            m_stream << ',' << name;
+        }
+
+        m_stream << '\n';
+    }
+
+    void write_record(const index row)
+    {
+        if (m_format == "csv") {
+            m_stream << row;
+
+            for (index column = 0; column < NbColumns; column++) {
+                m_stream << ',' << format("{:.17g}", value(column, row));
+            }
+        } else {
+            m_stream << "{\"iteration\": " << row;
+
+            for (index column = 0; column < NbColumns; column++) {
+                const double v = value(column, row);
+
+                // JSON has no representation for nan and inf
+
+                if (std::isfinite(v)) {
+                    m_stream << ", \"" << s_names[column] << "\": " << format("{:.17g}", v);
+                } else {
+                    m_stream << ", \"" << s_names[column] << "\": null";
+                }
+            }
+
+            m_stream << '}';
+        }
+
+        m_stream << std::endl;
+    }
+
+public: // constructors
+    Telemetry()
+        : m_buffer(std::make_shared<Buffer>())
+        , m_capacity(0)
+        , m_size(0)
+        , m_format("csv")
+    {
+    }
+
+public: // methods
+    index size() const noexcept
+    {
+        return m_size;
+    }
+
+    index capacity() const noexcept
+    {
+        return m_capacity;
+    }
+
+    const std::string& path() const noexcept
+    {
+        return m_path;
+    }
+
+    void set_path(const std::string& value) noexcept
+    {
+        m_path = value;
+    }
+
+    const std::string& stream_format() const noexcept
+    {
+        return m_format;
+    }
+
+    void set_stream_format(const std::string& value)
+    {
+        if (value != "csv" && value != "jsonl") {
+            throw std::invalid_argument("Format must be 'csv' or 'jsonl'");
+        }
+
+        m_format = value;
+    }
+
+    double value(const index column, const index row) const
+    {
+        return (*m_buffer)[column * m_capacity + row];
+    }
+
+    const double* data(const index column) const
+    {
+        return m_buffer->data() + column * m_capacity;
+    }
+
+    // allocates a new buffer, so arrays of a previous run stay untouched
+
+    void begin(const index capacity)
+    {
+        m_capacity = std::max(capacity, index(1));
+        m_size = 0;
+        m_buffer = std::make_shared<Buffer>(m_capacity * NbColumns, 0.0);
+
+        if (m_stream.is_open()) {
+            m_stream.close();
+        }
+
+        if (!m_path.empty()) {
+            m_stream.open(m_path, std::ios::out | std::ios::trunc);
+
+            if (!m_stream.is_open()) {
+                throw std::runtime_error("Could not open '" + m_path + "'");
+            }
+
+            write_header();
+        }
+    }
+
+    // records are silently dropped if the capacity is exceeded
+
+    void record(const double f, const double rnorm, const double xnorm, const double alpha, const double compute_time, const double factorize_time, const double solve_time)
+    {
+        if (m_size >= m_capacity) {
+            return;
+        }
+
+        const std::array<double, NbColumns> values = {f, rnorm, xnorm, alpha, compute_time, factorize_time, solve_time};
+
+        for (index column = 0; column < NbColumns; column++) {
+            (*m_buffer)[column * m_capacity + m_size] = values[column];
+        }
+
+        if (m_stream.is_open()) {
+            write_record(m_size);
+        }
+
+        m_size += 1;
+    }
+
+    void end()
+    {
+        if (m_stream.is_open()) {
+            m_stream.close();
+        }
+    }
+
+public: // python
+    template <typename TModule>
+    static void register_python(TModule& m)
+    {
+        namespace py = pybind11;
+        using namespace pybind11::literals;
+
+        using Holder = Pointer<Type>;
+
+        const auto column_view = [](const Column column) {
+            return [column](const Type& self) {
+                // the capsule keeps the buffer alive as long as the array exists
+
+                auto buffer = new Pointer<Buffer>(self.m_buffer);
+
+                py::capsule base(buffer, [](void* p) { delete reinterpret_cast<Pointer<Buffer>*>(p); });
+
+                py::array_t<double> array(self.size(), self.data(column), base);
+
+                py::detail::array_proxy(array.ptr())->flags &= ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+
+                return array;
+            };
+        };
+
+        py::class_<Type, Holder>(m, "Telemetry")
+            .def(py::init<>())
+            .def("__len__", &Type::size)
+            // properties
+            .def_property("path", &Type::path, &Type::set_path)
+            .def_property("stream_format", &Type::stream_format, &Type::set_stream_format)
+            // read-only properties
+            .def_property_readonly("size", &Type::size)
+            .def_property_readonly("capacity", &Type::capacity)
+            .def_property_readonly("f", column_view(F))
+            .def_property_readonly("rnorm", column_view(RNorm))
+            .def_property_readonly("xnorm", column_view(XNorm))
+            .def_property_readonly("alpha", column_view(Alpha))
+            .def_property_readonly("compute_time", column_view(ComputeTime))
+            .def_property_readonly("factorize_time", column_view(FactorizeTime))
+            .def_property_readonly("solve_time", column_view(SolveTime));
+    }
+}; // class Telemetry
+
+} // namespace eqlib
@@ -0,0 +1,253 @@
+#pragma once
+
+#include "Define.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace eqlib {
+
+/*
+* Timeline of the phases of the setup, the computation and the solvers.
+*
+* A span measures the time between its construction and its destruction. The
+* finished spans are buffered per thread and written as Chrome trace events,
+* which can be viewed in Perfetto or chrome://tracing. The buffer of a finished
+* thread is reused by the next new thread, so short-lived threads such as the
+* workers of compute_async share one track. If tracing is disabled,
+* a span only checks a flag. The names of the spans must be string literals.
+*/
+class Trace {
+private: // types
+    using Type = eqlib::Trace;
+    using Clock = std::chrono::steady_clock;
+
+    struct Event {
+        const char* name;
+        double begin;
+        double end;
+    };
+
+    struct Buffer {
+        index thread;
+        std::mutex mutex;
+        std::vector<Event> events;
+    };
+
+    // returns the buffer of a thread to the free list when the thread ends
+
+    struct Owner {
+        Buffer* buffer = nullptr;
+
+        ~Owner()
+        {
+            if (buffer != nullptr) {
+                std::lock_guard<std::mutex> lock(s_mutex);
+                s_free_buffers.push_back(buffer);
+            }
+        }
+    };
+
+private: // variables
+    static inline std::atomic<bool> s_enabled{false};
+
+    static inline std::mutex s_mutex;
+    static inline std::vector<Pointer<Buffer>> s_buffers;
+    static inline std::vector<Buffer*> s_free_buffers;
+
+    static inline const Clock::time_point s_start = Clock::now();
+
+private: // methods
+    // microseconds since the start of the program
+
+    static double now() noexcept
+    {
+        return std::chrono::duration<double, std::micro>(Clock::now() - s_start).count();
+    }
+
+    // buffer of the current thread. It is taken from the free list or
+    // created on the first span and lives until the end of the program
+
+    static Buffer& buffer()
+    {
+        thread_local Owner t_owner;
+
+        if (t_owner.buffer == nullptr) {
+            std::lock_guard<std::mutex> lock(s_mutex);
+
+            if (s_free_buffers.empty()) {
+                auto buffer = new_<Buffer>();
+                buffer->thread = length(s_buffers);
+
+                t_owner.buffer = buffer.get();
+                s_buffers.push_back(std::move(buffer));
+            } else {
+                t_owner.buffer = s_free_buffers.back();
+                s_free_buffers.pop_back();
+            }
+        }
+
+        return *t_owner.buffer;
+    }
+
+    static void record(const char* name, const double begin, const double end)
+    {
+        auto& current = buffer();
+
+        std::lock_guard<std::mutex> lock(current.mutex);
+
+        current.events.push_back({name, begin, end});
+    }
+
+public: // types
+    class Span {
+    private: // variables
+        const char* m_name;
+        double m_begin;
+        bool m_active;
+
+    public: // constructors
+        explicit Span(const char* name) noexcept
+            : m_name(name)
+            , m_begin(0.0)
+            , m_active(is_enabled())
+        {
+            if (m_active) {
+                m_begin = now();
+            }
+        }
+
+        Span(const Span&) = delete;
+
+        Span& operator=(const Span&) = delete;
+
+        ~Span()
+        {
+            end();
+        }
+
+    public: // methods
+        // finishes the span and starts the next phase
+
+        void step(const char* name)
+        {
+            end();
+
+            m_name = name;
+            m_active = is_enabled();
+
+            if (m_active) {
+                m_begin = now();
+            }
+        }
+
+        void end()
+        {
+            if (!m_active) {
+                return;
+            }
+
+            record(m_name, m_begin, now());
+
+            m_active = false;
+        }
+    };
+
+public: // methods
+    static bool is_enabled() noexcept
+    {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    static void set_enabled(const bool value) noexcept
+    {
+        s_enabled.store(value, std::memory_order_relaxed);
+    }
+
+    static index nb_events()
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+
+        index result = 0;
+
+        for (const auto& buffer : s_buffers) {
+            std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+            result += length(buffer->events);
+        }
+
+        return result;
+    }
+
+    static void clear()
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+
+        for (const auto& buffer : s_buffers) {
+            std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+            buffer->events.clear();
+        }
+    }
+
+    // writes the buffered spans in the JSON format of the Chrome trace
+    // events. The buffers are not cleared
+
+    static void write(const std::string& path)
+    {
+        std::ofstream stream(path);
+
+        if (!stream) {
+            throw std::runtime_error(format("Could not open '{}'", path));
+        }
+
+        std::lock_guard<std::mutex> lock(s_mutex);
+
+        stream << "{\"traceEvents\":[";
+
+        bool first = true;
+
+        for (const auto& buffer : s_buffers) {
+            std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+
+            if (buffer->events.empty()) {
+                continue;
+            }
+
+            stream << (first ? "\n" : ",\n");
+            stream << format(R"({{"name":"thread_name","ph":"M","pid":0,"tid":{0},"args":{{"name":"thread {0}"}}}})", buffer->thread);
+
+            first = false;
+
+            for (const auto& event : buffer->events) {
+                stream << ",\n";
+                stream << format(R"({{"name":"{}","cat":"eqlib","ph":"X","ts":{:.3f},"dur":{:.3f},"pid":0,"tid":{}}})", event.name, event.begin, event.end - event.begin, buffer->thread);
+            }
+        }
+
+        stream << "\n]}\n";
+
+        if (!stream) {
+            throw std::runtime_error(format("Could not write '{}'", path));
+        }
+    }
+
+public: // python
+    template <typename TModule>
+    static void register_python(TModule& m)
+    {
+        namespace py = pybind11;
+        using namespace pybind11::literals;
+
+        py::class_<Type>(m, "Trace")
+            .def_property_static("enabled", [](py::object) { return Type::is_enabled(); }, [](py::object, const bool value) { Type::set_enabled(value); })
+            .def_property_readonly_static("nb_events", [](py::object) { return Type::nb_events(); })
+            .def_static("clear", &Type::clear)
+            .def_static("write", &Type::write, "path"_a);
+    }
+};
+
+} // namespace eqlib
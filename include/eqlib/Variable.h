@@ -6,10 +6,28 @@
 
 namespace eqlib {
 
+class VariableArray;
+
+// contiguous arrays which hold the state of the variables owned by a problem
+
+struct VariableStorage {
+    double* values = nullptr;
+    double* lower_bounds = nullptr;
+    double* upper_bounds = nullptr;
+    double* multipliers = nullptr;
+};
+
+/*
+* A variable stores its value, bounds and multiplier in its own members. If it
+* is bound to a problem, the state lives at one index of the storage of that
+* problem instead. Unbound variables access their members directly.
+*/
 class Variable {
 private: // types
     using Type = Variable;
 
+    friend class VariableArray;
+
 private: // variables
     double m_act_value;
     double m_lower_bound;
@@ -18,6 +36,12 @@ private: // variables
     double m_multiplier;
     std::string m_name;
 
+    const VariableStorage* m_storage;
+    index m_storage_index;
+
+    size_t m_slot_problem;
+    index m_slot_index;
+
 public: // constructors
     Variable(
         const double value,
@@ -32,7 +56,27 @@ public: // constructors
         , m_is_active(is_active)
         , m_multiplier(multiplier)
         , m_name(name)
+        , m_storage(nullptr)
+        , m_storage_index(-1)
+        , m_slot_problem(0)
+        , m_slot_index(-1)
+    {
+    }
+
+    Variable(const Variable& other) noexcept
+        : Variable(other.value(), other.lower_bound(), other.upper_bound(), other.is_active(), other.multiplier(), other.name())
+    {
+    }
+
+    Variable& operator=(const Variable& other) noexcept
     {
+        set_value(other.value());
+        set_lower_bound(other.lower_bound());
+        set_upper_bound(other.upper_bound());
+        set_active(other.is_active());
+        set_multiplier(other.multiplier());
+        set_name(other.name());
+        return *this;
     }
 
     Variable() noexcept
@@ -59,37 +103,49 @@ public: // constructors
 public: // methods
     double value() const noexcept
     {
-        return m_act_value;
+        return m_storage == nullptr ? m_act_value : m_storage->values[m_storage_index];
     }
 
     double& value() noexcept
     {
-        return m_act_value;
+        return m_storage == nullptr ? m_act_value : m_storage->values[m_storage_index];
     }
 
     void set_value(const double value) noexcept
     {
-        m_act_value = value;
+        if (m_storage == nullptr) {
+            m_act_value = value;
+        } else {
+            m_storage->values[m_storage_index] = value;
+        }
     }
 
     double lower_bound() const noexcept
     {
-        return m_lower_bound;
+        return m_storage == nullptr ? m_lower_bound : m_storage->lower_bounds[m_storage_index];
     }
 
     void set_lower_bound(const double value) noexcept
     {
-        m_lower_bound = value;
+        if (m_storage == nullptr) {
+            m_lower_bound = value;
+        } else {
+            m_storage->lower_bounds[m_storage_index] = value;
+        }
     }
 
     double upper_bound() const noexcept
     {
-        return m_upper_bound;
+        return m_storage == nullptr ? m_upper_bound : m_storage->upper_bounds[m_storage_index];
     }
 
     void set_upper_bound(const double value) noexcept
     {
-        m_upper_bound = value;
+        if (m_storage == nullptr) {
+            m_upper_bound = value;
+        } else {
+            m_storage->upper_bounds[m_storage_index] = value;
+        }
     }
 
     bool is_active() const noexcept
@@ -104,12 +160,66 @@ public: // methods
 
     double multiplier() const noexcept
     {
-        return m_multiplier;
+        return m_storage == nullptr ? m_multiplier : m_storage->multipliers[m_storage_index];
     }
 
     void set_multiplier(const double value) noexcept
     {
-        m_multiplier = value;
+        if (m_storage == nullptr) {
+            m_multiplier = value;
+        } else {
+            m_storage->multipliers[m_storage_index] = value;
+        }
+    }
+
+    // the slot holds the index of the variable in the problem which was set up
+    // last with this variable
+
+    size_t slot_problem() const noexcept
+    {
+        return m_slot_problem;
+    }
+
+    index slot_index() const noexcept
+    {
+        return m_slot_index;
+    }
+
+    void set_slot(const size_t problem, const index index) noexcept
+    {
+        m_slot_problem = problem;
+        m_slot_index = index;
+    }
+
+    bool is_bound() const noexcept
+    {
+        return m_storage != nullptr;
+    }
+
+    // moves the current state to the given index of the storage
+
+    void bind(const VariableStorage* storage, const index index) noexcept
+    {
+        storage->values[index] = m_act_value;
+        storage->lower_bounds[index] = m_lower_bound;
+        storage->upper_bounds[index] = m_upper_bound;
+        storage->multipliers[index] = m_multiplier;
+
+        m_storage = storage;
+        m_storage_index = index;
+    }
+
+    // copies the state back from the storage to the own members
+
+    void unbind() noexcept
+    {
+        m_act_value = value();
+        m_lower_bound = lower_bound();
+        m_upper_bound = upper_bound();
+        m_multiplier = multiplier();
+
+        m_storage = nullptr;
+        m_storage_index = -1;
     }
 
     void clamp() noexcept
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "Define.h"
+#include "Variable.h"
+
+#include <stdexcept>
+#include <vector>
+
+namespace eqlib {
+
+/*
+* A set of variables created in one step. The variables are stored in
+* contiguous memory. The handles of the single variables share the ownership
+* of the whole array, so they can be passed to the elements like any other
+* variable.
+*
+* The views are strided arrays over the members of the variables. They show
+* the state of the variables as long as they are not bound to a problem which
+* owns them.
+*/
+class VariableArray {
+public: // types
+    using View = Eigen::Map<Vector, 0, Eigen::InnerStride<>>;
+
+private: // types
+    using Type = VariableArray;
+
+    struct Storage {
+        std::vector<Variable> variables;
+    };
+
+    static_assert(sizeof(Variable) % sizeof(double) == 0);
+
+    static constexpr index stride = sizeof(Variable) / sizeof(double);
+
+private: // variables
+    Pointer<Storage> m_storage;
+
+public: // constructors
+    VariableArray(
+        Ref<const Vector> values,
+        Ref<const Vector> lower_bounds,
+        Ref<const Vector> upper_bounds)
+        : m_storage(new_<Storage>())
+    {
+        const index n = length(values);
+
+        if (length(lower_bounds) != n || length(upper_bounds) != n) {
+            throw std::invalid_argument("Values and bounds must have the same size");
+        }
+
+        auto& variables = m_storage->variables;
+
+        variables.reserve(n);
+
+        for (index i = 0; i < n; i++) {
+            variables.emplace_back(values(i), lower_bounds(i), upper_bounds(i), true, 1.0, "");
+        }
+    }
+
+    VariableArray(Ref<const Vector> values)
+        : VariableArray(values, Vector::Constant(length(values), -infinity), Vector::Constant(length(values), infinity))
+    {
+    }
+
+private: // methods
+    void check_size(Ref<const Vector> value) const
+    {
+        if (length(value) != size()) {
+            throw std::invalid_argument(format("Expected {} values but got {}", size(), length(value)));
+        }
+    }
+
+    View view(double Variable::*member) const noexcept
+    {
+        auto& variables = m_storage->variables;
+
+        double* data = variables.empty() ? nullptr : &(variables.front().*member);
+
+        return View(data, size(), Eigen::InnerStride<>(stride));
+    }
+
+public: // methods
+    index size() const noexcept
+    {
+        return length(m_storage->variables);
+    }
+
+    Pointer<Variable> variable(const index i) const
+    {
+        if (i < 0 || size() <= i) {
+            throw std::out_of_range("Index out of range");
+        }
+
+        // the handle shares the ownership of the storage
+
+        return Pointer<Variable>(m_storage, &m_storage->variables[i]);
+    }
+
+    std::vector<Pointer<Variable>> variables() const
+    {
+        std::vector<Pointer<Variable>> result(size());
+
+        for (index i = 0; i < size(); i++) {
+            result[i] = Pointer<Variable>(m_storage, &m_storage->variables[i]);
+        }
+
+        return result;
+    }
+
+    View values() const noexcept
+    {
+        return view(&Variable::m_act_value);
+    }
+
+    View lower_bounds() const noexcept
+    {
+        return view(&Variable::m_lower_bound);
+    }
+
+    View upper_bounds() const noexcept
+    {
+        return view(&Variable::m_upper_bound);
+    }
+
+    View multipliers() const noexcept
+    {
+        return view(&Variable::m_multiplier);
+    }
+
+    void set_values(Ref<const Vector> value)
+    {
+        check_size(value);
+        values() = value;
+    }
+
+    void set_lower_bounds(Ref<const Vector> value)
+    {
+        check_size(value);
+        lower_bounds() = value;
+    }
+
+    void set_upper_bounds(Ref<const Vector> value)
+    {
+        check_size(value);
+        upper_bounds() = value;
+    }
+
+    void set_multipliers(Ref<const Vector> value)
+    {
+        check_size(value);
+        multipliers() = value;
+    }
+
+public: // python
+    template <typename TModule>
+    static void register_python(TModule& m)
+    {
+        namespace py = pybind11;
+        using namespace pybind11::literals;
+
+        using Holder = Pointer<Type>;
+
+        py::class_<Type, Holder>(m, "VariableArray")
+            // constructors
+            .def(py::init<Ref<const Vector>>(), "values"_a)
+            .def(py::init<Ref<const Vector>, Ref<const Vector>, Ref<const Vector>>(), "values"_a, "lower_bounds"_a, "upper_bounds"_a)
+            // methods
+            .def("__len__", &Type::size)
+            .def("__getitem__", &Type::variable, "index"_a)
+            // read-only properties
+            .def_property_readonly("variables", &Type::variables)
+            // properties
+            .def_property("values", &Type::values, &Type::set_values)
+            .def_property("lower_bounds", &Type::lower_bounds, &Type::set_lower_bounds)
+            .def_property("upper_bounds", &Type::upper_bounds, &Type::set_upper_bounds)
+            .def_property("multipliers", &Type::multipliers, &Type::set_multipliers);
+    }
+};
+
+} // namespace eqlib
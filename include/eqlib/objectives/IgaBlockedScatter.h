@@ -0,0 +1,99 @@
+#pragma once
+
+#include "../Define.h"
+
+#include <Eigen/Core>
+
+namespace eqlib {
+
+/*
+* Maps the derivatives of a function of TNbVectors interpolated vectors to the
+* coordinates of the nodes.
+*
+* The vector k is the product of the row k of the shape functions N with the
+* node locations. The variables of the function are ordered k * 3 + d, the
+* coordinates of the nodes i * 3 + d. For every pair of coordinates (rd, sd)
+* the hessian block is computed as a dense product N^T H_rd,sd N, where H_rd,sd
+* is the TNbVectors x TNbVectors slice of the hessian of the function.
+*
+* The workspace is allocated once for all integration points of an element.
+*/
+template <int TNbVectors, int TNbNodes>
+class IgaBlockedScatter {
+private: // types
+    using ShapeFunctions = Eigen::Matrix<double, TNbVectors, TNbNodes>;
+    using Block = Eigen::Matrix<double, TNbNodes, TNbNodes>;
+    using BlockMap = Eigen::Map<Block, 0, Eigen::Stride<Eigen::Dynamic, 3>>;
+    using NodeGradientMap = Eigen::Map<Eigen::Matrix<double, TNbNodes, 3>>;
+
+private: // variables
+    index m_nb_nodes;
+    ShapeFunctions m_n;
+    Eigen::Matrix<double, 3, TNbVectors> m_result_g;
+    Eigen::Matrix<double, TNbVectors, TNbVectors> m_result_h;
+    ShapeFunctions m_hn;
+    Block m_block;
+
+public: // constructor
+    IgaBlockedScatter(const index nb_nodes)
+        : m_nb_nodes(nb_nodes)
+        , m_n(TNbVectors, nb_nodes)
+        , m_hn(TNbVectors, nb_nodes)
+        , m_block(nb_nodes, nb_nodes)
+    {
+    }
+
+public: // methods
+    template <typename TShapeFunctions>
+    void set_shape_functions(const TShapeFunctions& shape_functions)
+    {
+        m_n = shape_functions.template cast<double>();
+    }
+
+    // g(i * 3 + d) += sum_k result.g(k * 3 + d) * N(k, i)
+
+    template <typename TResult, typename TGradient>
+    void add_gradient(const TResult& result, TGradient&& g)
+    {
+        for (index k = 0; k < TNbVectors; k++) {
+            for (index d = 0; d < 3; d++) {
+                m_result_g(d, k) = result.g(k * 3 + d);
+            }
+        }
+
+        NodeGradientMap(g.data(), m_nb_nodes, 3).noalias() += (m_result_g * m_n).transpose();
+    }
+
+    // h(i * 3 + rd, j * 3 + sd) += sum_k,l result.h(k * 3 + rd, l * 3 + sd) * N(k, i) * N(l, j)
+    //
+    // both triangles of h are written
+
+    template <typename TResult, typename THessian>
+    void add_hessian(const TResult& result, THessian&& h)
+    {
+        const index outer = h.outerStride();
+
+        const Eigen::Stride<Eigen::Dynamic, 3> stride(3 * outer, 3);
+
+        for (index rd = 0; rd < 3; rd++) {
+            for (index sd = rd; sd < 3; sd++) {
+                for (index k = 0; k < TNbVectors; k++) {
+                    for (index l = 0; l < TNbVectors; l++) {
+                        m_result_h(k, l) = result.h(k * 3 + rd, l * 3 + sd);
+                    }
+                }
+
+                m_hn.noalias() = m_result_h * m_n;
+                m_block.noalias() = m_n.transpose() * m_hn;
+
+                BlockMap(h.data() + rd * outer + sd, m_nb_nodes, m_nb_nodes, stride) += m_block;
+
+                if (rd != sd) {
+                    BlockMap(h.data() + sd * outer + rd, m_nb_nodes, m_nb_nodes, stride) += m_block.transpose();
+                }
+            }
+        }
+    }
+}; // class IgaBlockedScatter
+
+} // namespace eqlib
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "../Define.h"
+
+#include <Eigen/Core>
+
+#include <stdexcept>
+#include <vector>
+
+namespace eqlib {
+
+/*
+* Packed storage for the integration points of an IGA element.
+*
+* The shape functions of all points are stored in one contiguous, aligned
+* buffer and the reference quantities and weights in a second one. Every point
+* occupies a fixed number of entries in both buffers, so the points are read
+* as a stream without any allocation per point.
+*
+* The shape functions are stored as float if EQLIB_IGA_FLOAT_SHAPE_FUNCTIONS
+* is defined.
+*/
+class IgaIntegrationPoints {
+public: // types
+#ifdef EQLIB_IGA_FLOAT_SHAPE_FUNCTIONS
+    using Scalar = float;
+#else
+    using Scalar = double;
+#endif
+
+    using ShapeFunctions = Map<const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>;
+
+private: // types
+    template <typename T>
+    using Buffer = std::vector<T, Eigen::aligned_allocator<T>>;
+
+    // below this number of points append_many runs serially, because a
+    // typical element with 9 to 25 points does not amortize a thread team
+
+    static constexpr index MinParallelPoints = 64;
+
+private: // variables
+    index m_nb_shape_functions;
+    index m_nb_values;
+    index m_stride;
+    index m_size;
+    Buffer<Scalar> m_shape_functions;
+    Buffer<double> m_values;
+
+public: // constructor
+    IgaIntegrationPoints(const index nb_shape_functions, const index nb_values)
+        : m_nb_shape_functions(nb_shape_functions)
+        , m_nb_values(nb_values)
+        , m_size(0)
+    {
+        // pad each point to 16 bytes so every block starts aligned
+
+        const index align = 16 / sizeof(Scalar);
+
+        m_stride = (nb_shape_functions + align - 1) / align * align;
+    }
+
+public: // methods
+    // the first rows of the given shape functions. Throws if the shape
+    // functions do not match the element
+
+    static auto rows(const Matrix& shape_functions, const index nb_rows, const index nb_nodes)
+    {
+        if (shape_functions.rows() < nb_rows || shape_functions.cols() != nb_nodes) {
+            throw std::invalid_argument(format("Shape functions must have at least {} rows and {} columns", nb_rows, nb_nodes));
+        }
+
+        return shape_functions.topRows(nb_rows);
+    }
+
+    index size() const noexcept
+    {
+        return m_size;
+    }
+
+    void reserve(const index nb_points)
+    {
+        m_shape_functions.reserve(nb_points * m_stride);
+        m_values.reserve(nb_points * m_nb_values);
+    }
+
+    // appends the shape functions of a point and returns a pointer to its
+    // values, which have to be filled by the caller
+
+    template <typename... TShapeFunctions>
+    double* append(const TShapeFunctions&... shape_functions)
+    {
+        const index nb_shape_functions = (index(shape_functions.size()) + ...);
+
+        if (nb_shape_functions != m_nb_shape_functions) {
+            throw std::invalid_argument("Shape functions have an invalid size");
+        }
+
+        m_shape_functions.resize((m_size + 1) * m_stride, Scalar(0));
+        m_values.resize((m_size + 1) * m_nb_values, 0.0);
+
+        Scalar* it = m_shape_functions.data() + m_size * m_stride;
+
+        ((it = copy(shape_functions, it)), ...);
+
+        m_size += 1;
+
+        return m_values.data() + (m_size - 1) * m_nb_values;
+    }
+
+    // appends nb_points points with the shape functions stacked row by row in
+    // a buffer of size nb_points x nb_rows x nb_cols. Only the first
+    // nb_used_rows rows are stored. initialize(shape_functions, i, values) is
+    // called for every point to fill its values, in parallel for many points.
+    // Returns the index of the first point
+
+    template <typename TInitialize>
+    index append_many(const double* shape_functions, const index nb_points, const index nb_rows, const index nb_cols, const index nb_used_rows, TInitialize&& initialize)
+    {
+        if (nb_points < 0 || nb_rows < nb_used_rows || nb_used_rows * nb_cols != m_nb_shape_functions) {
+            throw std::invalid_argument(format("Shape functions must have at least {} rows and {} columns", nb_used_rows, m_nb_shape_functions / nb_used_rows));
+        }
+
+        using PointShapeFunctions = Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>;
+
+        const index first = m_size;
+
+        m_shape_functions.resize((m_size + nb_points) * m_stride, Scalar(0));
+        m_values.resize((m_size + nb_points) * m_nb_values, 0.0);
+
+        m_size += nb_points;
+
+        #pragma omp parallel for schedule(static) if(nb_points > MinParallelPoints)
+        for (index i = 0; i < nb_points; i++) {
+            const PointShapeFunctions point_shape_functions(shape_functions + i * nb_rows * nb_cols, nb_rows, nb_cols);
+
+            copy(point_shape_functions.topRows(nb_used_rows), m_shape_functions.data() + (first + i) * m_stride);
+
+            initialize(point_shape_functions, i, m_values.data() + (first + i) * m_nb_values);
+        }
+
+        return first;
+    }
+
+    // shape functions of point i. offset is the number of shape functions of
+    // the point stored before the requested block
+
+    ShapeFunctions shape_functions(const index i, const index rows, const index cols, const index offset = 0) const
+    {
+        return ShapeFunctions(m_shape_functions.data() + i * m_stride + offset, rows, cols);
+    }
+
+    // shape functions of point i with a size known at compile time. TCols
+    // may be Eigen::Dynamic
+
+    template <int TRows, int TCols>
+    Map<const Eigen::Matrix<Scalar, TRows, TCols, Eigen::RowMajor>> shape_functions(const index i, const index cols, const index offset = 0) const
+    {
+        return Map<const Eigen::Matrix<Scalar, TRows, TCols, Eigen::RowMajor>>(m_shape_functions.data() + i * m_stride + offset, TRows, cols);
+    }
+
+    const double* values(const index i) const noexcept
+    {
+        return m_values.data() + i * m_nb_values;
+    }
+
+private: // methods
+    template <typename TMatrix>
+    static Scalar* copy(const TMatrix& matrix, Scalar* it)
+    {
+        for (index row = 0; row < matrix.rows(); row++) {
+            for (index col = 0; col < matrix.cols(); col++) {
+                *it++ = static_cast<Scalar>(matrix(row, col));
+            }
+        }
+
+        return it;
+    }
+}; // class IgaIntegrationPoints
+
+} // namespace eqlib
@@ -0,0 +1,227 @@
+#pragma once
+
+#include "IgaBlockedScatter.h"
+#include "IgaIntegrationPoints.h"
+#include "IgaUtilities.h"
+
+#include "../Node.h"
+#include "../NodeLocations.h"
+#include "../Objective.h"
+
+#include <algorithm>
+
+namespace eqlib {
+
+/*
+* Membrane element with the closed-form first and second variation of the
+* membrane strain. It has the interface and the results of IgaMembrane3PAD.
+*/
+class IgaMembrane3P : public Objective {
+private: // types
+    using Type = IgaMembrane3P;
+
+    // values of an integration point: ref_a, transformation_matrix and weight
+
+    static constexpr index NbValues = 13;
+
+    // derivatives of the energy of a point with respect to a1 and a2
+
+    struct Derivatives {
+        Eigen::Matrix<double, 1, 6> m_g;
+        Eigen::Matrix<double, 6, 6> m_h;
+
+        double g(const index i) const
+        {
+            return m_g(i);
+        }
+
+        double h(const index i, const index j) const
+        {
+            return m_h(i, j);
+        }
+    };
+
+private: // variables
+    std::vector<Pointer<Node>> m_nodes;
+    Eigen::Matrix3d m_dm;
+    IgaIntegrationPoints m_points;
+
+public: // constructor
+    IgaMembrane3P(
+        const std::vector<Pointer<Node>>& nodes,
+        const double thickness,
+        const double youngs_modulus,
+        const double poissons_ratio)
+        : m_nodes(nodes)
+        , m_points(length(nodes) * 3, NbValues)
+    {
+        m_variables.reserve(length(nodes) * 3);
+
+        for (const auto& node : nodes) {
+            m_variables.push_back(node->x());
+            m_variables.push_back(node->y());
+            m_variables.push_back(node->z());
+        }
+
+        m_dm << 1, poissons_ratio, 0, poissons_ratio, 1, 0, 0, 0, (1 - poissons_ratio) / 2;
+        m_dm *= youngs_modulus * thickness / (1 - std::pow(poissons_ratio, 2));
+    }
+
+public: // methods
+    index add(const Matrix shape_functions, const double weight)
+    {
+        double* values = m_points.append(IgaIntegrationPoints::rows(shape_functions, 3, length(m_nodes)));
+
+        iga_utilities::membrane_reference_values(m_nodes, shape_functions, weight, values);
+
+        return m_points.size() - 1;
+    }
+
+    // adds nb_points points with the shape functions stacked row by row in a
+    // buffer of size nb_points x nb_rows x nb_nodes. The reference quantities
+    // are computed in parallel for many points. Returns the index of the
+    // first point
+
+    index add_many(const double* shape_functions, const index nb_points, const index nb_rows, const index nb_nodes, const double* weights)
+    {
+        return m_points.append_many(shape_functions, nb_points, nb_rows, nb_nodes, 3, [&](const auto& point_shape_functions, const index i, double* values) {
+            iga_utilities::membrane_reference_values(m_nodes, point_shape_functions, weights[i], values);
+        });
+    }
+
+    // TNbNodes is the number of nodes known at compile time or Eigen::Dynamic
+
+    template <int TOrder, int TNbNodes>
+    double compute(Ref<Vector> g, Ref<Matrix> h, const NodeLocations::View& node_locations) const
+    {
+        using namespace eqlib::iga_utilities;
+
+        static_assert(0 <= TOrder && TOrder <= 2);
+
+        constexpr int TNbDofs = nb_dofs<TNbNodes>;
+
+        const index nb_nodes = length(m_nodes);
+
+        const Eigen::Matrix<double, TNbNodes, 3> locations = node_locations.gather<TNbNodes>(m_nodes);
+
+        // a is a compile-time constant if the number of nodes is fixed
+
+        const index a = locations.rows() * 3;
+
+        Map<Eigen::Matrix<double, 1, TNbDofs>> local_g(g.data(), a);
+        Eigen::Map<Eigen::Matrix<double, TNbDofs, TNbDofs>, 0, Eigen::OuterStride<>> local_h(h.data(), a, a, Eigen::OuterStride<>(h.outerStride()));
+
+        IgaBlockedScatter<2, TNbNodes> scatter(nb_nodes);
+
+        Derivatives result;
+
+        double f = 0;
+
+        if constexpr (TOrder > 0) {
+            local_g.setZero();
+        }
+
+        if constexpr (TOrder > 1) {
+            local_h.setZero();
+        }
+
+        for (index i = 0; i < m_points.size(); i++) {
+            const auto shape_functions = m_points.template shape_functions<3, TNbNodes>(i, nb_nodes);
+            const double* values = m_points.values(i);
+
+            const Map<const Eigen::Vector3d> ref_a(values);
+            const Map<const Eigen::Matrix3d> transformation_matrix(values + 3);
+            const double weight = values[12];
+
+            const Eigen::Vector3d act_a1 = (shape_functions.row(1).template cast<double>() * locations).transpose();
+            const Eigen::Vector3d act_a2 = (shape_functions.row(2).template cast<double>() * locations).transpose();
+
+            const Eigen::Vector3d delta_a(act_a1.dot(act_a1) - ref_a(0), act_a2.dot(act_a2) - ref_a(1), act_a1.dot(act_a2) - ref_a(2));
+
+            const Eigen::Vector3d eps = 0.5 * transformation_matrix * delta_a;
+
+            const Eigen::Vector3d weighted_stress = weight * m_dm * eps;
+
+            f += 0.5 * eps.dot(weighted_stress);
+
+            if constexpr (TOrder == 0) {
+                continue;
+            }
+
+            // derivative of the energy with respect to the metric (a11, a22,
+            // a12) and the derivatives of the metric with respect to a1, a2
+
+            const Eigen::Vector3d n = 0.5 * transformation_matrix.transpose() * weighted_stress;
+
+            Eigen::Matrix<double, 3, 6> da;
+            da << 2 * act_a1.transpose(), Eigen::RowVector3d::Zero(), Eigen::RowVector3d::Zero(), 2 * act_a2.transpose(), act_a2.transpose(), act_a1.transpose();
+
+            result.m_g.noalias() = n.transpose() * da;
+
+            scatter.set_shape_functions(shape_functions.template bottomRows<2>());
+            scatter.add_gradient(result, local_g);
+
+            if constexpr (TOrder > 1) {
+                const Eigen::Matrix3d k = 0.25 * weight * transformation_matrix.transpose() * m_dm * transformation_matrix;
+
+                result.m_h.noalias() = da.transpose() * k * da;
+
+                result.m_h.template topLeftCorner<3, 3>().diagonal().array() += 2 * n(0);
+                result.m_h.template bottomRightCorner<3, 3>().diagonal().array() += 2 * n(1);
+                result.m_h.template topRightCorner<3, 3>().diagonal().array() += n(2);
+                result.m_h.template bottomLeftCorner<3, 3>().diagonal().array() += n(2);
+
+                scatter.add_hessian(result, local_h);
+            }
+        }
+
+        return f;
+    }
+
+    template <int TOrder>
+    double compute(Ref<Vector> g, Ref<Matrix> h, const NodeLocations::View& node_locations) const
+    {
+        return iga_utilities::dispatch_nb_nodes(length(m_nodes), [&](auto nb_nodes) {
+            return compute<TOrder, decltype(nb_nodes)::value>(g, h, node_locations);
+        });
+    }
+
+    double compute_gathered(Ref<Vector> g, Ref<Matrix> h, const NodeLocations::View& node_locations) const override
+    {
+        if (g.size() == 0) {
+            return compute<0>(g, h, node_locations);
+        } else if (h.size() == 0) {
+            return compute<1>(g, h, node_locations);
+        } else {
+            return compute<2>(g, h, node_locations);
+        }
+    }
+
+    double compute(Ref<Vector> g, Ref<Matrix> h) const override
+    {
+        return compute_gathered(g, h, NodeLocations::View());
+    }
+
+    std::vector<Pointer<Node>> gathered_nodes() const override
+    {
+        return m_nodes;
+    }
+
+public: // python
+    template <typename TModule>
+    static void register_python(TModule& m)
+    {
+        namespace py = pybind11;
+        using namespace pybind11::literals;
+
+        using Holder = Pointer<Type>;
+        using Base = Objective;
+
+        py::class_<Type, Base, Holder>(m, "IgaMembrane3P")
+            .def(py::init<std::vector<Pointer<Node>>, double, double, double>(), "nodes"_a, "thickness"_a, "youngs_modulus"_a, "poissons_ratio"_a)
+            .def("add", &Type::add, "shape_functions"_a, "weight"_a)
+            .def("add_many", iga_utilities::add_many_python<Type>(), "shape_functions"_a, "weights"_a);
+    }
+}; // class IgaMembrane3P
+
+} // namespace eqlib
\ No newline at end of file
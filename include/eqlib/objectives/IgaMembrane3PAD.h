@@ -1,10 +1,16 @@
 #pragma once
 
+#include "IgaBlockedScatter.h"
+#include "IgaIntegrationPoints.h"
 #include "IgaUtilities.h"
 
+#include "../BatchedJet.h"
 #include "../Node.h"
+#include "../NodeLocations.h"
 #include "../Objective.h"
 
+#include <algorithm>
+
 #include <hyperjet/hyperjet.h>
 
 namespace eqlib {
@@ -13,17 +19,18 @@ class IgaMembrane3PAD : public Objective {
 private: // types
     using Type = IgaMembrane3PAD;
 
-    struct Data {
-        Matrix shape_functions;
-        Eigen::Matrix<double, 1, 3> ref_a;
-        Eigen::Matrix3d transformation_matrix;
-        double weight;
-    };
+    // values of an integration point: ref_a, transformation_matrix and weight
+
+    static constexpr index NbValues = 13;
+
+    // number of integration points evaluated in lockstep at order 1 and 2
+
+    static constexpr int BatchSize = 4;
 
 private: // variables
     std::vector<Pointer<Node>> m_nodes;
     Eigen::Matrix3d m_dm;
-    std::vector<Data> m_data;
+    IgaIntegrationPoints m_points;
 
 public: // constructor
     IgaMembrane3PAD(
@@ -32,10 +39,11 @@ public: // constructor
         const double youngs_modulus,
         const double poissons_ratio)
         : m_nodes(nodes)
+        , m_points(length(nodes) * 3, NbValues)
     {
         m_variables.reserve(length(nodes) * 3);
 
-        for (const auto node : nodes) {
+        for (const auto& node : nodes) {
             m_variables.push_back(node->x());
             m_variables.push_back(node->y());
             m_variables.push_back(node->z());
@@ -48,66 +56,75 @@ public: // constructor
 public: // methods
     index add(const Matrix shape_functions, const double weight)
     {
-        using namespace Eigen;
-        using namespace eqlib::iga_utilities;
-
-        const Vector3d ref_a1 = evaluate_ref_geometry(m_nodes, shape_functions.row(1));
-        const Vector3d ref_a2 = evaluate_ref_geometry(m_nodes, shape_functions.row(2));
-
-        const Vector3d ref_a(ref_a1.dot(ref_a1), ref_a2.dot(ref_a2), ref_a1.dot(ref_a2));
-
-        const Vector3d e1 = ref_a1.normalized();
-        const Vector3d e2 = (ref_a2 - ref_a2.dot(e1) * e1).normalized();
-
-        const double det = ref_a(0) * ref_a(1) - ref_a(2) * ref_a(2);
-
-        const Vector3d g_ab_con(ref_a(1) / det, ref_a(0) / det, -ref_a(2) / det);
-
-        const Vector3d g_con1 = g_ab_con[0] * ref_a1 + g_ab_con[2] * ref_a2;
-        const Vector3d g_con2 = g_ab_con[2] * ref_a1 + g_ab_con[1] * ref_a2;
+        double* values = m_points.append(IgaIntegrationPoints::rows(shape_functions, 3, length(m_nodes)));
 
-        const double eg11 = e1.dot(g_con1);
-        const double eg12 = e1.dot(g_con2);
-        const double eg21 = e2.dot(g_con1);
-        const double eg22 = e2.dot(g_con2);
+        iga_utilities::membrane_reference_values(m_nodes, shape_functions, weight, values);
 
-        Matrix3d transformation_matrix;
-        transformation_matrix << eg11 * eg11, eg12 * eg12, 2 * eg11 * eg12, eg21 * eg21, eg22 * eg22, 2 * eg21 * eg22, 2 * eg11 * eg21, 2 * eg12 * eg22, 2 * (eg11 * eg22 + eg12 * eg21);
+        return m_points.size() - 1;
+    }
 
-        m_data.emplace_back<Data>({shape_functions, ref_a, transformation_matrix, weight});
+    // adds nb_points points with the shape functions stacked row by row in a
+    // buffer of size nb_points x nb_rows x nb_nodes. The reference quantities
+    // are computed in parallel for many points. Returns the index of the
+    // first point
 
-        return m_data.size() - 1;
+    index add_many(const double* shape_functions, const index nb_points, const index nb_rows, const index nb_nodes, const double* weights)
+    {
+        return m_points.append_many(shape_functions, nb_points, nb_rows, nb_nodes, 3, [&](const auto& point_shape_functions, const index i, double* values) {
+            iga_utilities::membrane_reference_values(m_nodes, point_shape_functions, weights[i], values);
+        });
     }
 
-    template <int TOrder>
-    double compute(Ref<Vector> g, Ref<Matrix> h) const
+    // evaluates one integration point at a time.
+    //
+    // TNbNodes is the number of nodes known at compile time or Eigen::Dynamic
+
+    template <int TOrder, int TNbNodes>
+    double compute_pointwise(Ref<Vector> g, Ref<Matrix> h, const NodeLocations::View& node_locations) const
     {
         using namespace eqlib::iga_utilities;
         using Space = hyperjet::Space<TOrder, double, 6>;
 
         static_assert(0 <= TOrder && TOrder <= 2);
 
+        constexpr int TNbDofs = nb_dofs<TNbNodes>;
+
         const index nb_nodes = length(m_nodes);
 
-        Eigen::Matrix<double, Eigen::Dynamic, 3> locations(nb_nodes, 3);
+        const Eigen::Matrix<double, TNbNodes, 3> locations = node_locations.gather<TNbNodes>(m_nodes);
 
-        for (index i = 0; i < nb_nodes; i++) {
-            locations.row(i) = m_nodes[i]->act_location();
-        }
+        // a is a compile-time constant if the number of nodes is fixed
+
+        const index a = locations.rows() * 3;
+
+        Map<Eigen::Matrix<double, 1, TNbDofs>> local_g(g.data(), a);
+        Eigen::Map<Eigen::Matrix<double, TNbDofs, TNbDofs>, 0, Eigen::OuterStride<>> local_h(h.data(), a, a, Eigen::OuterStride<>(h.outerStride()));
+
+        // the first derivatives are taken with respect to a1 and a2, which are
+        // interpolated by the rows 1 and 2
+
+        IgaBlockedScatter<2, TNbNodes> scatter(nb_nodes);
 
         double f = 0;
 
         if constexpr (TOrder > 0) {
-            g.setZero();
+            local_g.setZero();
         }
 
         if constexpr (TOrder > 1) {
-            h.setZero();
+            local_h.setZero();
         }
 
-        for (const auto& [shape_functions, ref_a, transformation_matrix, weight] : m_data) {
-            const auto act_a1 = Space::template variables<0, 3>(shape_functions.row(1) * locations);
-            const auto act_a2 = Space::template variables<3, 3>(shape_functions.row(2) * locations);
+        for (index i = 0; i < m_points.size(); i++) {
+            const auto shape_functions = m_points.template shape_functions<3, TNbNodes>(i, nb_nodes);
+            const double* values = m_points.values(i);
+
+            const Map<const Eigen::Matrix<double, 1, 3>> ref_a(values);
+            const Map<const Eigen::Matrix3d> transformation_matrix(values + 3);
+            const double weight = values[12];
+
+            const auto act_a1 = Space::template variables<0, 3>(shape_functions.row(1).template cast<double>() * locations);
+            const auto act_a2 = Space::template variables<3, 3>(shape_functions.row(2).template cast<double>() * locations);
 
             const typename Space::template Vector<3> act_a(act_a1.dot(act_a1), act_a2.dot(act_a2), act_a1.dot(act_a2));
 
@@ -115,33 +132,107 @@ public: // methods
 
             const auto result = 0.5 * weight * eps.dot(m_dm * eps);
 
-            const index a = shape_functions.cols() * 3;
-
             f += Space::f(result);
 
             if constexpr (TOrder > 0) {
-                for (index r = 0; r < a; r++) {
-                    const index rd = r % 3;
-                    const index ri = r / 3;
+                scatter.set_shape_functions(shape_functions.template bottomRows<2>());
+                scatter.add_gradient(result, local_g);
+            }
+
+            if constexpr (TOrder > 1) {
+                scatter.add_hessian(result, local_h);
+            }
+        }
+
+        return f;
+    }
+
+    // evaluates BatchSize integration points at a time. The last batch is
+    // padded with copies of the last point
+
+    template <int TOrder, int TNbNodes>
+    double compute_batched(Ref<Vector> g, Ref<Matrix> h, const NodeLocations::View& node_locations) const
+    {
+        using Jet = BatchedJet<TOrder, BatchSize, 6>;
+        using Lanes = typename Jet::Lanes;
+
+        static_assert(1 <= TOrder && TOrder <= 2);
+
+        constexpr int TNbDofs = iga_utilities::nb_dofs<TNbNodes>;
+
+        const index nb_nodes = length(m_nodes);
+
+        const Eigen::Matrix<double, TNbNodes, 3> locations = node_locations.gather<TNbNodes>(m_nodes);
+
+        const index a = locations.rows() * 3;
+
+        Map<Eigen::Matrix<double, 1, TNbDofs>> local_g(g.data(), a);
+        Eigen::Map<Eigen::Matrix<double, TNbDofs, TNbDofs>, 0, Eigen::OuterStride<>> local_h(h.data(), a, a, Eigen::OuterStride<>(h.outerStride()));
+
+        IgaBlockedScatter<2, TNbNodes> scatter(nb_nodes);
+
+        local_g.setZero();
 
-                    g(0 + r) += result.g(0 + rd) * shape_functions(1, ri) + result.g(3 + rd) * shape_functions(2, ri);
+        if constexpr (TOrder > 1) {
+            local_h.setZero();
+        }
+
+        // the values of a1 and a2 and the values of the integration points of
+        // every lane
+
+        Eigen::Array<double, BatchSize, 6, Eigen::ColMajor> x;
+        Eigen::Array<double, BatchSize, NbValues, Eigen::ColMajor> values;
+
+        double f = 0;
+
+        for (index begin = 0; begin < m_points.size(); begin += BatchSize) {
+            const index nb_lanes = std::min<index>(BatchSize, m_points.size() - begin);
+
+            for (index lane = 0; lane < BatchSize; lane++) {
+                const index i = begin + std::min(lane, nb_lanes - 1);
+
+                const auto shape_functions = m_points.template shape_functions<3, TNbNodes>(i, nb_nodes);
+
+                for (index k = 0; k < 2; k++) {
+                    x.row(lane).template segment<3>(k * 3) = (shape_functions.row(1 + k).template cast<double>() * locations).array();
                 }
+
+                values.row(lane) = Map<const Eigen::Array<double, 1, NbValues>>(m_points.values(i));
             }
 
-            if constexpr (TOrder > 1) {
-                for (index r = 0; r < a; r++) {
-                    const index rd = r % 3;
-                    const index ri = r / 3;
-
-                    for (index s = r; s < a; s++) {
-                        const index sd = s % 3;
-                        const index si = s / 3;
-
-                        h(0 + r, 0 + s) += result.h(0 + rd, 0 + sd) * shape_functions(1, ri) * shape_functions(1, si)
-                            + result.h(3 + rd, 0 + sd) * shape_functions(2, ri) * shape_functions(1, si)
-                            + result.h(0 + rd, 3 + sd) * shape_functions(1, ri) * shape_functions(2, si)
-                            + result.h(3 + rd, 3 + sd) * shape_functions(2, ri) * shape_functions(2, si);
-                    }
+            const auto act_a1 = Jet::template variables<0>(x);
+            const auto act_a2 = Jet::template variables<3>(x);
+
+            const typename Jet::Vector3 delta_a = {dot(act_a1, act_a1) - values.col(0), dot(act_a2, act_a2) - values.col(1), dot(act_a1, act_a2) - values.col(2)};
+
+            // the transformation matrix is stored row by row
+
+            typename Jet::Vector3 eps;
+
+            for (index r = 0; r < 3; r++) {
+                eps[r] = (delta_a[0] * Lanes(values.col(3 + r * 3)) + delta_a[1] * Lanes(values.col(4 + r * 3)) + delta_a[2] * Lanes(values.col(5 + r * 3))) * 0.5;
+            }
+
+            typename Jet::Vector3 dm_eps;
+
+            for (index r = 0; r < 3; r++) {
+                dm_eps[r] = eps[0] * m_dm(r, 0) + eps[1] * m_dm(r, 1) + eps[2] * m_dm(r, 2);
+            }
+
+            const Lanes weight = values.col(12);
+
+            const auto result = dot(eps, dm_eps) * Lanes(0.5 * weight);
+
+            for (index lane = 0; lane < nb_lanes; lane++) {
+                const auto shape_functions = m_points.template shape_functions<3, TNbNodes>(begin + lane, nb_nodes);
+
+                f += result.f()(lane);
+
+                scatter.set_shape_functions(shape_functions.template bottomRows<2>());
+                scatter.add_gradient(result.lane(lane), local_g);
+
+                if constexpr (TOrder > 1) {
+                    scatter.add_hessian(result.lane(lane), local_h);
                 }
             }
         }
@@ -149,17 +240,45 @@ public: // methods
         return f;
     }
 
-    double compute(Ref<Vector> g, Ref<Matrix> h) const override
+    template <int TOrder, int TNbNodes>
+    double compute(Ref<Vector> g, Ref<Matrix> h, const NodeLocations::View& node_locations) const
+    {
+        if constexpr (TOrder == 0) {
+            return compute_pointwise<TOrder, TNbNodes>(g, h, node_locations);
+        } else {
+            return compute_batched<TOrder, TNbNodes>(g, h, node_locations);
+        }
+    }
+
+    template <int TOrder>
+    double compute(Ref<Vector> g, Ref<Matrix> h, const NodeLocations::View& node_locations) const
+    {
+        return iga_utilities::dispatch_nb_nodes(length(m_nodes), [&](auto nb_nodes) {
+            return compute<TOrder, decltype(nb_nodes)::value>(g, h, node_locations);
+        });
+    }
+
+    double compute_gathered(Ref<Vector> g, Ref<Matrix> h, const NodeLocations::View& node_locations) const override
     {
         if (g.size() == 0) {
-            return compute<0>(g, h);
+            return compute<0>(g, h, node_locations);
         } else if (h.size() == 0) {
-            return compute<1>(g, h);
+            return compute<1>(g, h, node_locations);
         } else {
-            return compute<2>(g, h);
+            return compute<2>(g, h, node_locations);
         }
     }
 
+    double compute(Ref<Vector> g, Ref<Matrix> h) const override
+    {
+        return compute_gathered(g, h, NodeLocations::View());
+    }
+
+    std::vector<Pointer<Node>> gathered_nodes() const override
+    {
+        return m_nodes;
+    }
+
 public: // python
     template <typename TModule>
     static void register_python(TModule& m)
@@ -172,7 +291,8 @@ public: // python
 
         py::class_<Type, Base, Holder>(m, "IgaMembrane3PAD")
             .def(py::init<std::vector<Pointer<Node>>, double, double, double>(), "nodes"_a, "thickness"_a, "youngs_modulus"_a, "poissons_ratio"_a)
-            .def("add", &Type::add, "shape_functions"_a, "weight"_a);
+            .def("add", &Type::add, "shape_functions"_a, "weight"_a)
+            .def("add_many", iga_utilities::add_many_python<Type>(), "shape_functions"_a, "weights"_a);
     }
 }; // class IgaMembrane3PAD
 
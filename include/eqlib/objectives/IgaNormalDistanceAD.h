@@ -1,8 +1,10 @@
 #pragma once
 
+#include "IgaIntegrationPoints.h"
 #include "IgaUtilities.h"
 
 #include "../Node.h"
+#include "../NodeLocations.h"
 #include "../Objective.h"
 
 #include <hyperjet/hyperjet.h>
@@ -13,16 +15,12 @@ class IgaNormalDistanceAD : public Objective {
 private: // types
     using Type = IgaNormalDistanceAD;
 
-    struct Data {
-        Matrix shape_functions_a;
-        Matrix shape_functions_b;
-        double weight;
-    };
+    static constexpr index NbRows = 3;
 
 private: // variables
     std::vector<Pointer<Node>> m_nodes_a;
     std::vector<Pointer<Node>> m_nodes_b;
-    std::vector<Data> m_data;
+    IgaIntegrationPoints m_points;
 
 public: // constructor
     IgaNormalDistanceAD(
@@ -30,16 +28,17 @@ public: // constructor
         std::vector<Pointer<Node>> nodes_b)
         : m_nodes_a(nodes_a)
         , m_nodes_b(nodes_b)
+        , m_points((length(nodes_a) + length(nodes_b)) * NbRows, 1)
     {
         m_variables.reserve(length(nodes_a) * 3 + length(nodes_b) * 3);
 
-        for (const auto node : nodes_a) {
+        for (const auto& node : nodes_a) {
             m_variables.push_back(node->x());
             m_variables.push_back(node->y());
             m_variables.push_back(node->z());
         }
 
-        for (const auto node : nodes_b) {
+        for (const auto& node : nodes_b) {
             m_variables.push_back(node->x());
             m_variables.push_back(node->y());
             m_variables.push_back(node->z());
@@ -49,26 +48,52 @@ public: // constructor
 public: // methods
     index add(const Matrix shape_functions_a, const Matrix shape_functions_b, const double weight)
     {
-        m_data.emplace_back<Data>({shape_functions_a, shape_functions_b, weight});
-        return m_data.size() - 1;
+        const auto rows_a = IgaIntegrationPoints::rows(shape_functions_a, NbRows, length(m_nodes_a));
+        const auto rows_b = IgaIntegrationPoints::rows(shape_functions_b, NbRows, length(m_nodes_b));
+
+        double* values = m_points.append(rows_a, rows_b);
+
+        values[0] = weight;
+
+        return m_points.size() - 1;
     }
 
-    template <int TOrder>
-    double compute(Ref<Vector> g, Ref<Matrix> h) const
+    // TNbNodesA and TNbNodesB are the numbers of nodes known at compile time
+    // or Eigen::Dynamic
+
+    template <int TOrder, int TNbNodesA, int TNbNodesB>
+    double compute(Ref<Vector> g, Ref<Matrix> h, const NodeLocations::View& node_locations) const
     {
         using namespace eqlib::iga_utilities;
         using Space = hyperjet::Space<TOrder, double, 12>;
 
         static_assert(0 <= TOrder && TOrder <= 2);
 
+        constexpr int TNbDofs = nb_dofs<TNbNodesA, TNbNodesB>;
+
+        const index n = length(m_variables);
+
+        Map<Eigen::Matrix<double, 1, TNbDofs>> local_g(g.data(), n);
+        Eigen::Map<Eigen::Matrix<double, TNbDofs, TNbDofs>, 0, Eigen::OuterStride<>> local_h(h.data(), n, n, Eigen::OuterStride<>(h.outerStride()));
+
         double f = 0;
 
-        for (const auto& [shape_functions_a, shape_functions_b, weight] : m_data) {
-            const auto a1_a = Space::template variables<0, 3>(evaluate_act_geometry(m_nodes_a, shape_functions_a.row(1)));
-            const auto a2_a = Space::template variables<3, 3>(evaluate_act_geometry(m_nodes_a, shape_functions_a.row(2)));
+        const index nb_nodes_a = length(m_nodes_a);
+        const index nb_nodes_b = length(m_nodes_b);
+
+        const Eigen::Matrix<double, TNbNodesA, 3> locations_a = node_locations.gather<TNbNodesA>(m_nodes_a);
+        const Eigen::Matrix<double, TNbNodesB, 3> locations_b = node_locations.gather<TNbNodesB>(m_nodes_b, nb_nodes_a);
+
+        for (index i = 0; i < m_points.size(); i++) {
+            const auto shape_functions_a = m_points.template shape_functions<NbRows, TNbNodesA>(i, nb_nodes_a);
+            const auto shape_functions_b = m_points.template shape_functions<NbRows, TNbNodesB>(i, nb_nodes_b, NbRows * nb_nodes_a);
+            const double weight = m_points.values(i)[0];
 
-            const auto a1_b = Space::template variables<6, 3>(evaluate_act_geometry(m_nodes_b, shape_functions_b.row(1)));
-            const auto a2_b = Space::template variables<9, 3>(evaluate_act_geometry(m_nodes_b, shape_functions_b.row(2)));
+            const auto a1_a = Space::template variables<0, 3>(evaluate_act_geometry(locations_a, shape_functions_a.row(1)));
+            const auto a2_a = Space::template variables<3, 3>(evaluate_act_geometry(locations_a, shape_functions_a.row(2)));
+
+            const auto a1_b = Space::template variables<6, 3>(evaluate_act_geometry(locations_b, shape_functions_b.row(1)));
+            const auto a2_b = Space::template variables<9, 3>(evaluate_act_geometry(locations_b, shape_functions_b.row(2)));
 
             const auto a3_a = a1_a.cross(a2_a).normalized();
             const auto a3_b = a1_b.cross(a2_b).normalized();
@@ -85,14 +110,14 @@ public: // methods
                     const index rd = r % 3;
                     const index ri = r / 3;
 
-                    g(0 + r) = result.g(0 + rd) * shape_functions_a(1, ri) + result.g(3 + rd) * shape_functions_a(2, ri);
+                    local_g(0 + r) = result.g(0 + rd) * shape_functions_a(1, ri) + result.g(3 + rd) * shape_functions_a(2, ri);
                 }
 
                 for (index r = 0; r < b; r++) {
                     const index rd = r % 3;
                     const index ri = r / 3;
 
-                    g(a + r) = result.g(6 + rd) * shape_functions_b(1, ri) + result.g(9 + rd) * shape_functions_b(2, ri);
+                    local_g(a + r) = result.g(6 + rd) * shape_functions_b(1, ri) + result.g(9 + rd) * shape_functions_b(2, ri);
                 }
             }
 
@@ -105,7 +130,7 @@ public: // methods
                         const index sd = s % 3;
                         const index si = s / 3;
 
-                        h(0 + r, 0 + s) = result.h(0 + rd, 0 + sd) * shape_functions_a(1, ri) * shape_functions_a(1, si)
+                        local_h(0 + r, 0 + s) = result.h(0 + rd, 0 + sd) * shape_functions_a(1, ri) * shape_functions_a(1, si)
                             + result.h(3 + rd, 0 + sd) * shape_functions_a(2, ri) * shape_functions_a(1, si)
                             + result.h(0 + rd, 3 + sd) * shape_functions_a(1, ri) * shape_functions_a(2, si)
                             + result.h(3 + rd, 3 + sd) * shape_functions_a(2, ri) * shape_functions_a(2, si);
@@ -115,7 +140,7 @@ public: // methods
                         const index sd = s % 3;
                         const index si = s / 3;
 
-                        h(0 + r, a + s) = result.h(0 + rd, 6 + sd) * shape_functions_a(1, ri) * shape_functions_b(1, si)
+                        local_h(0 + r, a + s) = result.h(0 + rd, 6 + sd) * shape_functions_a(1, ri) * shape_functions_b(1, si)
                             + result.h(3 + rd, 6 + sd) * shape_functions_a(2, ri) * shape_functions_b(1, si)
                             + result.h(0 + rd, 9 + sd) * shape_functions_a(1, ri) * shape_functions_b(2, si)
                             + result.h(3 + rd, 9 + sd) * shape_functions_a(2, ri) * shape_functions_b(2, si);
@@ -130,7 +155,7 @@ public: // methods
                         const index sd = s % 3;
                         const index si = s / 3;
 
-                        h(a + r, a + s) = result.h(6 + rd, 6 + sd) * shape_functions_b(1, ri) * shape_functions_b(1, si)
+                        local_h(a + r, a + s) = result.h(6 + rd, 6 + sd) * shape_functions_b(1, ri) * shape_functions_b(1, si)
                             + result.h(9 + rd, 6 + sd) * shape_functions_b(2, ri) * shape_functions_b(1, si)
                             + result.h(6 + rd, 9 + sd) * shape_functions_b(1, ri) * shape_functions_b(2, si)
                             + result.h(9 + rd, 9 + sd) * shape_functions_b(2, ri) * shape_functions_b(2, si);
@@ -144,17 +169,41 @@ public: // methods
         return f;
     }
 
-    double compute(Ref<Vector> g, Ref<Matrix> h) const override
+    template <int TOrder>
+    double compute(Ref<Vector> g, Ref<Matrix> h, const NodeLocations::View& node_locations) const
+    {
+        using namespace eqlib::iga_utilities;
+
+        return dispatch_nb_nodes(length(m_nodes_a), [&](auto nb_nodes_a) {
+            return dispatch_nb_nodes(length(m_nodes_b), [&](auto nb_nodes_b) {
+                return compute<TOrder, decltype(nb_nodes_a)::value, decltype(nb_nodes_b)::value>(g, h, node_locations);
+            });
+        });
+    }
+
+    double compute_gathered(Ref<Vector> g, Ref<Matrix> h, const NodeLocations::View& node_locations) const override
     {
         if (g.size() == 0) {
-            return compute<0>(g, h);
+            return compute<0>(g, h, node_locations);
         } else if (h.size() == 0) {
-            return compute<1>(g, h);
+            return compute<1>(g, h, node_locations);
         } else {
-            return compute<2>(g, h);
+            return compute<2>(g, h, node_locations);
         }
     }
 
+    double compute(Ref<Vector> g, Ref<Matrix> h) const override
+    {
+        return compute_gathered(g, h, NodeLocations::View());
+    }
+
+    std::vector<Pointer<Node>> gathered_nodes() const override
+    {
+        std::vector<Pointer<Node>> nodes(m_nodes_a);
+        nodes.insert(nodes.end(), m_nodes_b.begin(), m_nodes_b.end());
+        return nodes;
+    }
+
 public: // python
     template <typename TModule>
     static void register_python(TModule& m)
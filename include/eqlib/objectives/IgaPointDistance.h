@@ -1,8 +1,10 @@
 #pragma once
 
+#include "IgaIntegrationPoints.h"
 #include "IgaUtilities.h"
 
 #include "../Node.h"
+#include "../NodeLocations.h"
 #include "../Objective.h"
 
 #include <hyperjet/hyperjet.h>
@@ -13,16 +15,12 @@ class IgaPointDistance : public Objective {
 private: // types
     using Type = IgaPointDistance;
 
-    struct Data {
-        Matrix shape_functions_a;
-        Matrix shape_functions_b;
-        double weight;
-    };
+    static constexpr index NbRows = 1;
 
 private: // variables
     std::vector<Pointer<Node>> m_nodes_a;
     std::vector<Pointer<Node>> m_nodes_b;
-    std::vector<Data> m_data;
+    IgaIntegrationPoints m_points;
 
 public: // constructor
     IgaPointDistance(
@@ -30,16 +28,21 @@ public: // constructor
         std::vector<Pointer<Node>> nodes_b)
         : m_nodes_a(nodes_a)
         , m_nodes_b(nodes_b)
+        , m_points((length(nodes_a) + length(nodes_b)) * NbRows, 1)
     {
+        // the hessian depends only on the shape functions and weights
+
+        m_has_constant_hessian = true;
+
         m_variables.reserve(length(nodes_a) * 3 + length(nodes_b) * 3);
 
-        for (const auto node : nodes_a) {
+        for (const auto& node : nodes_a) {
             m_variables.push_back(node->x());
             m_variables.push_back(node->y());
             m_variables.push_back(node->z());
         }
 
-        for (const auto node : nodes_b) {
+        for (const auto& node : nodes_b) {
             m_variables.push_back(node->x());
             m_variables.push_back(node->y());
             m_variables.push_back(node->z());
@@ -49,12 +52,20 @@ public: // constructor
 public: // methods
     index add(const Matrix shape_functions_a, const Matrix shape_functions_b, const double weight)
     {
-        m_data.emplace_back<Data>({shape_functions_a, shape_functions_b, weight});
-        return m_data.size() - 1;
+        const auto rows_a = IgaIntegrationPoints::rows(shape_functions_a, NbRows, length(m_nodes_a));
+        const auto rows_b = IgaIntegrationPoints::rows(shape_functions_b, NbRows, length(m_nodes_b));
+
+        double* values = m_points.append(rows_a, rows_b);
+
+        values[0] = weight;
+
+        increment_revision();
+
+        return m_points.size() - 1;
     }
 
     template <int TOrder>
-    double compute(Ref<Vector> g, Ref<Matrix> h) const
+    double compute(Ref<Vector> g, Ref<Matrix> h, const NodeLocations::View& node_locations) const
     {
         using namespace eqlib::iga_utilities;
 
@@ -64,9 +75,19 @@ public: // methods
         g.setZero();
         h.setZero();
 
-        for (const auto& [shape_functions_a, shape_functions_b, weight] : m_data) {
-            Vector3D point_a = evaluate_act_geometry(m_nodes_a, shape_functions_a.row(0));
-            Vector3D point_b = evaluate_act_geometry(m_nodes_b, shape_functions_b.row(0));
+        const index nb_nodes_a = length(m_nodes_a);
+        const index nb_nodes_b = length(m_nodes_b);
+
+        const Eigen::Matrix<double, Eigen::Dynamic, 3> locations_a = node_locations.gather(m_nodes_a);
+        const Eigen::Matrix<double, Eigen::Dynamic, 3> locations_b = node_locations.gather(m_nodes_b, nb_nodes_a);
+
+        for (index i = 0; i < m_points.size(); i++) {
+            const auto shape_functions_a = m_points.shape_functions(i, NbRows, nb_nodes_a);
+            const auto shape_functions_b = m_points.shape_functions(i, NbRows, nb_nodes_b, NbRows * nb_nodes_a);
+            const double weight = m_points.values(i)[0];
+
+            Vector3D point_a = evaluate_act_geometry(locations_a, shape_functions_a.row(0));
+            Vector3D point_b = evaluate_act_geometry(locations_b, shape_functions_b.row(0));
 
             const Vector3D delta = point_b - point_a;
 
@@ -132,17 +153,29 @@ public: // methods
         return f;
     }
 
-    double compute(Ref<Vector> g, Ref<Matrix> h) const override
+    double compute_gathered(Ref<Vector> g, Ref<Matrix> h, const NodeLocations::View& node_locations) const override
     {
         if (g.size() == 0) {
-            return compute<0>(g, h);
+            return compute<0>(g, h, node_locations);
         } else if (h.size() == 0) {
-            return compute<1>(g, h);
+            return compute<1>(g, h, node_locations);
         } else {
-            return compute<2>(g, h);
+            return compute<2>(g, h, node_locations);
         }
     }
 
+    double compute(Ref<Vector> g, Ref<Matrix> h) const override
+    {
+        return compute_gathered(g, h, NodeLocations::View());
+    }
+
+    std::vector<Pointer<Node>> gathered_nodes() const override
+    {
+        std::vector<Pointer<Node>> nodes(m_nodes_a);
+        nodes.insert(nodes.end(), m_nodes_b.begin(), m_nodes_b.end());
+        return nodes;
+    }
+
 public: // python
     template <typename TModule>
     static void register_python(TModule& m)
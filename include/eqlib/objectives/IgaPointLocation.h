@@ -1,30 +1,37 @@
 #pragma once
 
+#include "IgaIntegrationPoints.h"
 #include "IgaUtilities.h"
 
 #include "../Node.h"
+#include "../NodeLocations.h"
 #include "../Objective.h"
 
+#include <algorithm>
+
 namespace eqlib {
 
 class IgaPointLocation : public Objective {
 private: // types
     using Type = IgaPointLocation;
 
-    struct Data {
-        Matrix shape_functions;
-        Vector3D location;
-        double weight;
-    };
+    // values of an integration point: target and weight
+
+    static constexpr index NbValues = 4;
 
 private: // variables
     std::vector<Pointer<Node>> m_nodes;
-    std::vector<Data> m_data;
+    IgaIntegrationPoints m_points;
 
 public: // constructor
     IgaPointLocation(std::vector<Pointer<Node>> nodes)
         : m_nodes(nodes)
+        , m_points(length(nodes), NbValues)
     {
+        // the hessian depends only on the shape functions and weights
+
+        m_has_constant_hessian = true;
+
         m_variables.resize(length(nodes) * 3);
         for (index i = 0; i < length(nodes); i++) {
             m_variables[i * 3 + 0] = nodes[i]->x();
@@ -36,12 +43,22 @@ public: // constructor
 public: // methods
     index add(const Matrix shape_functions, const Vector target, const double weight)
     {
-        m_data.emplace_back<Data>({shape_functions, target, weight});
-        return m_data.size() - 1;
+        if (length(target) != 3) {
+            throw std::invalid_argument("Target must have 3 components");
+        }
+
+        double* values = m_points.append(IgaIntegrationPoints::rows(shape_functions, 1, length(m_nodes)));
+
+        std::copy_n(target.data(), 3, values);
+        values[3] = weight;
+
+        increment_revision();
+
+        return m_points.size() - 1;
     }
 
     template <int TOrder>
-    double compute(Ref<Vector> g, Ref<Matrix> h) const
+    double compute(Ref<Vector> g, Ref<Matrix> h, const NodeLocations::View& node_locations) const
     {
         using namespace eqlib::iga_utilities;
 
@@ -51,8 +68,16 @@ public: // methods
         g.setZero();
         h.setZero();
 
-        for (const auto& [shape_functions, target, weight] : m_data) {
-            const Vector3D act_x = evaluate_act_geometry(m_nodes, shape_functions.row(0));
+        const Eigen::Matrix<double, Eigen::Dynamic, 3> locations = node_locations.gather(m_nodes);
+
+        for (index k = 0; k < m_points.size(); k++) {
+            const auto shape_functions = m_points.shape_functions(k, 1, length(m_nodes));
+            const double* values = m_points.values(k);
+
+            const Map<const Vector3D> target(values);
+            const double weight = values[3];
+
+            const Vector3D act_x = evaluate_act_geometry(locations, shape_functions.row(0));
 
             const Vector3D delta = act_x - target;
 
@@ -80,17 +105,27 @@ public: // methods
         return f;
     }
 
-    double compute(Ref<Vector> g, Ref<Matrix> h) const override
+    double compute_gathered(Ref<Vector> g, Ref<Matrix> h, const NodeLocations::View& node_locations) const override
     {
         if (g.size() == 0) {
-            return compute<0>(g, h);
+            return compute<0>(g, h, node_locations);
         } else if (h.size() == 0) {
-            return compute<1>(g, h);
+            return compute<1>(g, h, node_locations);
         } else {
-            return compute<2>(g, h);
+            return compute<2>(g, h, node_locations);
         }
     }
 
+    double compute(Ref<Vector> g, Ref<Matrix> h) const override
+    {
+        return compute_gathered(g, h, NodeLocations::View());
+    }
+
+    std::vector<Pointer<Node>> gathered_nodes() const override
+    {
+        return m_nodes;
+    }
+
 public: // python
     template <typename TModule>
     static void register_python(TModule& m)
@@ -0,0 +1,320 @@
+#pragma once
+
+#include "IgaBlockedScatter.h"
+#include "IgaIntegrationPoints.h"
+#include "IgaUtilities.h"
+
+#include "../Node.h"
+#include "../NodeLocations.h"
+#include "../Objective.h"
+
+#include <algorithm>
+#include <array>
+
+namespace eqlib {
+
+/*
+* Kirchhoff-Love shell element with the closed-form first and second
+* variation of the membrane strain and the bending curvature. It has the
+* interface and the results of IgaShell3PAD.
+*/
+class IgaShell3P : public Objective {
+private: // types
+    using Type = IgaShell3P;
+
+    // values of an integration point: ref_a, ref_b, transformation_matrix
+    // and weight
+
+    static constexpr index NbValues = 16;
+
+    // derivatives of the energy of a point with respect to a1, a2, a1_1,
+    // a1_2 and a2_2
+
+    struct Derivatives {
+        Eigen::Matrix<double, 1, 15> m_g;
+        Eigen::Matrix<double, 15, 15> m_h;
+
+        double g(const index i) const
+        {
+            return m_g(i);
+        }
+
+        double h(const index i, const index j) const
+        {
+            return m_h(i, j);
+        }
+    };
+
+private: // variables
+    std::vector<Pointer<Node>> m_nodes;
+    Eigen::Matrix3d m_dm;
+    Eigen::Matrix3d m_db;
+    IgaIntegrationPoints m_points;
+
+private: // methods
+    static Eigen::Matrix3d skew(const Eigen::Vector3d& v)
+    {
+        Eigen::Matrix3d result;
+        result << 0, -v(2), v(1), v(2), 0, -v(0), -v(1), v(0), 0;
+        return result;
+    }
+
+public: // constructor
+    IgaShell3P(
+        const std::vector<Pointer<Node>>& nodes,
+        const double thickness,
+        const double youngs_modulus,
+        const double poissons_ratio)
+        : m_nodes(nodes)
+        , m_points(length(nodes) * 6, NbValues)
+    {
+        m_variables.reserve(length(nodes) * 3);
+
+        for (const auto& node : nodes) {
+            m_variables.push_back(node->x());
+            m_variables.push_back(node->y());
+            m_variables.push_back(node->z());
+        }
+
+        m_dm << 1, poissons_ratio, 0, poissons_ratio, 1, 0, 0, 0, (1 - poissons_ratio) / 2;
+        m_dm *= youngs_modulus * thickness / (1 - std::pow(poissons_ratio, 2));
+
+        m_db << 1, poissons_ratio, 0, poissons_ratio, 1, 0, 0, 0, (1 - poissons_ratio) / 2;
+        m_db *= youngs_modulus * std::pow(thickness, 3) / (12 * (1 - std::pow(poissons_ratio, 2)));
+    }
+
+public: // methods
+    index add(const Matrix shape_functions, const double weight)
+    {
+        double* values = m_points.append(IgaIntegrationPoints::rows(shape_functions, 6, length(m_nodes)));
+
+        iga_utilities::shell_reference_values(m_nodes, shape_functions, weight, values);
+
+        return m_points.size() - 1;
+    }
+
+    // adds nb_points points with the shape functions stacked row by row in a
+    // buffer of size nb_points x nb_rows x nb_nodes. The reference quantities
+    // are computed in parallel for many points. Returns the index of the
+    // first point
+
+    index add_many(const double* shape_functions, const index nb_points, const index nb_rows, const index nb_nodes, const double* weights)
+    {
+        return m_points.append_many(shape_functions, nb_points, nb_rows, nb_nodes, 6, [&](const auto& point_shape_functions, const index i, double* values) {
+            iga_utilities::shell_reference_values(m_nodes, point_shape_functions, weights[i], values);
+        });
+    }
+
+    // TNbNodes is the number of nodes known at compile time or Eigen::Dynamic
+
+    template <int TOrder, int TNbNodes>
+    double compute(Ref<Vector> g, Ref<Matrix> h, const NodeLocations::View& node_locations) const
+    {
+        using namespace eqlib::iga_utilities;
+
+        using Vector3d = Eigen::Vector3d;
+        using Matrix3d = Eigen::Matrix3d;
+
+        static_assert(0 <= TOrder && TOrder <= 2);
+
+        constexpr int TNbDofs = nb_dofs<TNbNodes>;
+
+        const index nb_nodes = length(m_nodes);
+
+        const Eigen::Matrix<double, TNbNodes, 3> locations = node_locations.gather<TNbNodes>(m_nodes);
+
+        // a is a compile-time constant if the number of nodes is fixed
+
+        const index a = locations.rows() * 3;
+
+        Map<Eigen::Matrix<double, 1, TNbDofs>> local_g(g.data(), a);
+        Eigen::Map<Eigen::Matrix<double, TNbDofs, TNbDofs>, 0, Eigen::OuterStride<>> local_h(h.data(), a, a, Eigen::OuterStride<>(h.outerStride()));
+
+        IgaBlockedScatter<5, TNbNodes> scatter(nb_nodes);
+
+        Derivatives result;
+
+        double f = 0;
+
+        if constexpr (TOrder > 0) {
+            local_g.setZero();
+        }
+
+        if constexpr (TOrder > 1) {
+            local_h.setZero();
+        }
+
+        // the curvature k is the product of c_k with a3. Like IgaShell3PAD,
+        // the curvatures are ordered b11, b22, b12
+
+        constexpr std::array<index, 3> c_offsets = {6, 12, 9};
+
+        for (index i = 0; i < m_points.size(); i++) {
+            const auto shape_functions = m_points.template shape_functions<6, TNbNodes>(i, nb_nodes);
+            const double* values = m_points.values(i);
+
+            const Map<const Vector3d> ref_a(values);
+            const Map<const Vector3d> ref_b(values + 3);
+            const Map<const Matrix3d> transformation_matrix(values + 6);
+            const double weight = values[15];
+
+            Eigen::Matrix<double, 15, 1> x;
+
+            for (index k = 0; k < 5; k++) {
+                x.template segment<3>(k * 3) = (shape_functions.row(1 + k).template cast<double>() * locations).transpose();
+            }
+
+            const auto act_a1 = x.template segment<3>(0);
+            const auto act_a2 = x.template segment<3>(3);
+
+            const std::array<Vector3d, 3> c = {x.template segment<3>(c_offsets[0]), x.template segment<3>(c_offsets[1]), x.template segment<3>(c_offsets[2])};
+
+            const Vector3d v = act_a1.cross(act_a2);
+            const double l = v.norm();
+            const Vector3d act_a3 = v / l;
+
+            const Vector3d delta_a(act_a1.dot(act_a1) - ref_a(0), act_a2.dot(act_a2) - ref_a(1), act_a1.dot(act_a2) - ref_a(2));
+            const Vector3d delta_b(c[0].dot(act_a3) - ref_b(0), c[1].dot(act_a3) - ref_b(1), c[2].dot(act_a3) - ref_b(2));
+
+            const Vector3d eps = 0.5 * transformation_matrix * delta_a;
+            const Vector3d kap = transformation_matrix * delta_b;
+
+            const Vector3d weighted_stress_m = weight * m_dm * eps;
+            const Vector3d weighted_stress_b = weight * m_db * kap;
+
+            f += 0.5 * (eps.dot(weighted_stress_m) + kap.dot(weighted_stress_b));
+
+            if constexpr (TOrder == 0) {
+                continue;
+            }
+
+            // derivatives of the energy with respect to the metric and the
+            // curvature
+
+            const Vector3d n_a = 0.5 * transformation_matrix.transpose() * weighted_stress_m;
+            const Vector3d n_b = transformation_matrix.transpose() * weighted_stress_b;
+
+            // derivatives of a3 with respect to a1 and a2
+
+            const Matrix3d p = (Matrix3d::Identity() - act_a3 * act_a3.transpose()) / l;
+
+            const Matrix3d da3_da1 = -p * skew(act_a2);
+            const Matrix3d da3_da2 = p * skew(act_a1);
+
+            // derivatives of the metric and the curvature with respect to the
+            // variables
+
+            Eigen::Matrix<double, 3, 15> da = Eigen::Matrix<double, 3, 15>::Zero();
+            da.template block<1, 3>(0, 0) = 2 * act_a1.transpose();
+            da.template block<1, 3>(1, 3) = 2 * act_a2.transpose();
+            da.template block<1, 3>(2, 0) = act_a2.transpose();
+            da.template block<1, 3>(2, 3) = act_a1.transpose();
+
+            Eigen::Matrix<double, 3, 15> db = Eigen::Matrix<double, 3, 15>::Zero();
+
+            for (index k = 0; k < 3; k++) {
+                db.template block<1, 3>(k, 0) = c[k].transpose() * da3_da1;
+                db.template block<1, 3>(k, 3) = c[k].transpose() * da3_da2;
+                db.template block<1, 3>(k, c_offsets[k]) = act_a3.transpose();
+            }
+
+            result.m_g.noalias() = n_a.transpose() * da + n_b.transpose() * db;
+
+            scatter.set_shape_functions(shape_functions.template bottomRows<5>());
+            scatter.add_gradient(result, local_g);
+
+            if constexpr (TOrder > 1) {
+                const Matrix3d k_a = 0.25 * weight * transformation_matrix.transpose() * m_dm * transformation_matrix;
+                const Matrix3d k_b = weight * transformation_matrix.transpose() * m_db * transformation_matrix;
+
+                result.m_h.noalias() = da.transpose() * k_a * da;
+                result.m_h.noalias() += db.transpose() * k_b * db;
+
+                // second derivatives of the metric
+
+                result.m_h.template block<3, 3>(0, 0).diagonal().array() += 2 * n_a(0);
+                result.m_h.template block<3, 3>(3, 3).diagonal().array() += 2 * n_a(1);
+                result.m_h.template block<3, 3>(0, 3).diagonal().array() += n_a(2);
+                result.m_h.template block<3, 3>(3, 0).diagonal().array() += n_a(2);
+
+                // second derivatives of the curvature. With c = sum n_b(k) c_k
+                // the terms with respect to a1 and a2 follow from the second
+                // derivative m of c * v / |v| and from the second derivative
+                // of v = a1 x a2
+
+                const Vector3d c_n = n_b(0) * c[0] + n_b(1) * c[1] + n_b(2) * c[2];
+                const double b_n = c_n.dot(act_a3);
+
+                const Matrix3d m = (3 * b_n * act_a3 * act_a3.transpose() - c_n * act_a3.transpose() - act_a3 * c_n.transpose() - b_n * Matrix3d::Identity()) / (l * l);
+
+                Eigen::Matrix<double, 3, 6> dv;
+                dv << -skew(act_a2), skew(act_a1);
+
+                result.m_h.template block<6, 6>(0, 0).noalias() += dv.transpose() * m * dv;
+
+                const Matrix3d u = skew(p * c_n);
+
+                result.m_h.template block<3, 3>(0, 3) -= u;
+                result.m_h.template block<3, 3>(3, 0) += u;
+
+                for (index k = 0; k < 3; k++) {
+                    result.m_h.template block<3, 3>(c_offsets[k], 0) += n_b(k) * da3_da1;
+                    result.m_h.template block<3, 3>(c_offsets[k], 3) += n_b(k) * da3_da2;
+                    result.m_h.template block<3, 3>(0, c_offsets[k]) += n_b(k) * da3_da1.transpose();
+                    result.m_h.template block<3, 3>(3, c_offsets[k]) += n_b(k) * da3_da2.transpose();
+                }
+
+                scatter.add_hessian(result, local_h);
+            }
+        }
+
+        return f;
+    }
+
+    template <int TOrder>
+    double compute(Ref<Vector> g, Ref<Matrix> h, const NodeLocations::View& node_locations) const
+    {
+        return iga_utilities::dispatch_nb_nodes(length(m_nodes), [&](auto nb_nodes) {
+            return compute<TOrder, decltype(nb_nodes)::value>(g, h, node_locations);
+        });
+    }
+
+    double compute_gathered(Ref<Vector> g, Ref<Matrix> h, const NodeLocations::View& node_locations) const override
+    {
+        if (g.size() == 0) {
+            return compute<0>(g, h, node_locations);
+        } else if (h.size() == 0) {
+            return compute<1>(g, h, node_locations);
+        } else {
+            return compute<2>(g, h, node_locations);
+        }
+    }
+
+    double compute(Ref<Vector> g, Ref<Matrix> h) const override
+    {
+        return compute_gathered(g, h, NodeLocations::View());
+    }
+
+    std::vector<Pointer<Node>> gathered_nodes() const override
+    {
+        return m_nodes;
+    }
+
+public: // python
+    template <typename TModule>
+    static void register_python(TModule& m)
+    {
+        namespace py = pybind11;
+        using namespace pybind11::literals;
+
+        using Holder = Pointer<Type>;
+        using Base = Objective;
+
+        py::class_<Type, Base, Holder>(m, "IgaShell3P")
+            .def(py::init<std::vector<Pointer<Node>>, double, double, double>(), "nodes"_a, "thickness"_a, "youngs_modulus"_a, "poissons_ratio"_a)
+            .def("add", &Type::add, "shape_functions"_a, "weight"_a)
+            .def("add_many", iga_utilities::add_many_python<Type>(), "shape_functions"_a, "weights"_a);
+    }
+}; // class IgaShell3P
+
+} // namespace eqlib
\ No newline at end of file
@@ -5,32 +5,166 @@
 
 #include <hyperjet/hyperjet.h>
 
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
 namespace eqlib {
 
 namespace iga_utilities {
 
-Vector3D evaluate_ref_geometry(const std::vector<Pointer<Node>>& nodes, Ref<const Vector> shape_functions)
+// calls the function with the number of nodes as compile-time constant for
+// the common patches with 9 (biquadratic) and 16 (bicubic) control points and
+// with Eigen::Dynamic otherwise
+
+template <typename TFunction>
+auto dispatch_nb_nodes(const index nb_nodes, TFunction&& function)
+{
+    switch (nb_nodes) {
+    case 9:
+        return function(std::integral_constant<int, 9>());
+    case 16:
+        return function(std::integral_constant<int, 16>());
+    default:
+        return function(std::integral_constant<int, Eigen::Dynamic>());
+    }
+}
+
+// python binding of add_many for a numpy array of shape (nb_points, nb_rows,
+// nb_nodes) with the shape functions and an array of nb_points weights. The
+// GIL is released while the points are added
+
+template <typename TElement>
+auto add_many_python()
+{
+    namespace py = pybind11;
+
+    using Array = py::array_t<double, py::array::c_style | py::array::forcecast>;
+
+    return [](TElement& self, Array shape_functions, Array weights) {
+        if (shape_functions.ndim() != 3) {
+            throw std::invalid_argument("Shape functions must be an array of shape (nb_points, nb_rows, nb_nodes)");
+        }
+
+        if (weights.ndim() != 1 || weights.shape(0) != shape_functions.shape(0)) {
+            throw std::invalid_argument("Weights must be an array of shape (nb_points,)");
+        }
+
+        py::gil_scoped_release release;
+
+        return self.add_many(shape_functions.data(), shape_functions.shape(0), shape_functions.shape(1), shape_functions.shape(2), weights.data());
+    };
+}
+
+// number of dofs of the nodes at compile time or Eigen::Dynamic
+
+template <int... TNbNodes>
+constexpr int nb_dofs = ((TNbNodes == Eigen::Dynamic) || ...) ? Eigen::Dynamic : (TNbNodes + ...) * 3;
+
+template <typename TShapeFunctions>
+Vector3D evaluate_ref_geometry(const std::vector<Pointer<Node>>& nodes, const TShapeFunctions& shape_functions)
 {
     Vector3D value = Vector3D::Zero();
 
     for (index i = 0; i < length(nodes); i++) {
-        value += nodes[i]->ref_location() * shape_functions(i);
+        value += nodes[i]->ref_location() * double(shape_functions(i));
     }
 
     return value;
 }
 
-Vector3D evaluate_act_geometry(const std::vector<Pointer<Node>>& nodes, Ref<const Vector> shape_functions)
+template <typename TShapeFunctions>
+Vector3D evaluate_act_geometry(const std::vector<Pointer<Node>>& nodes, const TShapeFunctions& shape_functions)
 {
     Vector3D value = Vector3D::Zero();
 
     for (index i = 0; i < length(nodes); i++) {
-        value += nodes[i]->act_location() * shape_functions(i);
+        value += nodes[i]->act_location() * double(shape_functions(i));
     }
 
     return value;
 }
 
+// evaluates the geometry with gathered locations as a dense product of a row
+// of shape functions and the locations. The shape functions may be stored as
+// float
+
+template <typename TLocations, typename TShapeFunctions>
+Vector3D evaluate_act_geometry(const Eigen::MatrixBase<TLocations>& locations, const TShapeFunctions& shape_functions)
+{
+    return (shape_functions.template cast<double>() * locations).transpose();
+}
+
+// transformation of the strains from the curvilinear base of the reference
+// configuration to a local cartesian base
+
+inline Eigen::Matrix3d transformation_matrix(const Vector3D& ref_a1, const Vector3D& ref_a2, const Vector3D& ref_a)
+{
+    const Vector3D e1 = ref_a1.normalized();
+    const Vector3D e2 = (ref_a2 - ref_a2.dot(e1) * e1).normalized();
+
+    const double det = ref_a(0) * ref_a(1) - ref_a(2) * ref_a(2);
+
+    const Vector3D g_ab_con(ref_a(1) / det, ref_a(0) / det, -ref_a(2) / det);
+
+    const Vector3D g_con1 = g_ab_con[0] * ref_a1 + g_ab_con[2] * ref_a2;
+    const Vector3D g_con2 = g_ab_con[2] * ref_a1 + g_ab_con[1] * ref_a2;
+
+    const double eg11 = e1.dot(g_con1);
+    const double eg12 = e1.dot(g_con2);
+    const double eg21 = e2.dot(g_con1);
+    const double eg22 = e2.dot(g_con2);
+
+    Eigen::Matrix3d result;
+    result << eg11 * eg11, eg12 * eg12, 2 * eg11 * eg12, eg21 * eg21, eg22 * eg22, 2 * eg21 * eg22, 2 * eg11 * eg21, 2 * eg12 * eg22, 2 * (eg11 * eg22 + eg12 * eg21);
+
+    return result;
+}
+
+// computes the reference quantities of a membrane point. Writes ref_a, the
+// transformation matrix and the weight as 13 values
+
+template <typename TShapeFunctions>
+void membrane_reference_values(const std::vector<Pointer<Node>>& nodes, const TShapeFunctions& shape_functions, const double weight, double* values)
+{
+    const Vector3D ref_a1 = evaluate_ref_geometry(nodes, shape_functions.row(1));
+    const Vector3D ref_a2 = evaluate_ref_geometry(nodes, shape_functions.row(2));
+
+    const Vector3D ref_a(ref_a1.dot(ref_a1), ref_a2.dot(ref_a2), ref_a1.dot(ref_a2));
+
+    const Eigen::Matrix3d transformation = transformation_matrix(ref_a1, ref_a2, ref_a);
+
+    std::copy_n(ref_a.data(), 3, values);
+    std::copy_n(transformation.data(), 9, values + 3);
+    values[12] = weight;
+}
+
+// computes the reference quantities of a shell point. Writes ref_a, ref_b,
+// the transformation matrix and the weight as 16 values
+
+template <typename TShapeFunctions>
+void shell_reference_values(const std::vector<Pointer<Node>>& nodes, const TShapeFunctions& shape_functions, const double weight, double* values)
+{
+    const Vector3D ref_a1 = evaluate_ref_geometry(nodes, shape_functions.row(1));
+    const Vector3D ref_a2 = evaluate_ref_geometry(nodes, shape_functions.row(2));
+
+    const Vector3D ref_a1_1 = evaluate_ref_geometry(nodes, shape_functions.row(3));
+    const Vector3D ref_a1_2 = evaluate_ref_geometry(nodes, shape_functions.row(4));
+    const Vector3D ref_a2_2 = evaluate_ref_geometry(nodes, shape_functions.row(5));
+
+    const Vector3D ref_a3 = ref_a1.cross(ref_a2).normalized();
+
+    const Vector3D ref_a(ref_a1.dot(ref_a1), ref_a2.dot(ref_a2), ref_a1.dot(ref_a2));
+    const Vector3D ref_b(ref_a1_1.dot(ref_a3), ref_a1_2.dot(ref_a3), ref_a2_2.dot(ref_a3));
+
+    const Eigen::Matrix3d transformation = transformation_matrix(ref_a1, ref_a2, ref_a);
+
+    std::copy_n(ref_a.data(), 3, values);
+    std::copy_n(ref_b.data(), 3, values + 3);
+    std::copy_n(transformation.data(), 9, values + 6);
+    values[15] = weight;
+}
+
 auto evaluate_act_geometry_hj(const std::vector<Pointer<Node>>& nodes, Ref<const Vector> shape_functions)
 {
     using Space = hyperjet::Space<2, double, -1>;
@@ -6,30 +6,44 @@
 #include <pybind11/stl.h>
 #include <pybind11/stl_bind.h>
 
+#include <eqlib/ArcLength.h>
 #include <eqlib/Armijo.h>
+#include <eqlib/BatchObjective.h>
+#include <eqlib/CFunctionConstraint.h>
+#include <eqlib/CFunctionObjective.h>
+#include <eqlib/ConjugateGradient.h>
 #include <eqlib/Constraint.h>
 #include <eqlib/Equation.h>
+#include <eqlib/Future.h>
+#include <eqlib/InteriorPoint.h>
 #include <eqlib/LambdaConstraint.h>
 #include <eqlib/LambdaObjective.h>
+#include <eqlib/LoadStepping.h>
 #include <eqlib/Log.h>
 #include <eqlib/NewtonRaphson.h>
 #include <eqlib/Node.h>
+#include <eqlib/NodeArray.h>
 #include <eqlib/Objective.h>
 #include <eqlib/Parameter.h>
 #include <eqlib/Problem.h>
 #include <eqlib/SteepestDecent.h>
 #include <eqlib/SparseLU.h>
 #include <eqlib/SparseStructure.h>
+#include <eqlib/Telemetry.h>
+#include <eqlib/Trace.h>
 #include <eqlib/Variable.h>
+#include <eqlib/VariableArray.h>
 
 #include <eqlib/Info.h>
 
 #include <eqlib/objectives/IgaNormalDistanceAD.h>
+#include <eqlib/objectives/IgaMembrane3P.h>
 #include <eqlib/objectives/IgaMembrane3PAD.h>
 #include <eqlib/objectives/IgaPointDistance.h>
 #include <eqlib/objectives/IgaPointDistanceAD.h>
 #include <eqlib/objectives/IgaPointLocation.h>
 #include <eqlib/objectives/IgaRotationCouplingAD.h>
+#include <eqlib/objectives/IgaShell3P.h>
 #include <eqlib/objectives/IgaShell3PAD.h>
 
 PYBIND11_MODULE(eqlib, m)
@@ -59,6 +73,9 @@ PYBIND11_MODULE(eqlib, m)
     // Variable
     eqlib::Variable::register_python(m);
 
+    // VariableArray
+    eqlib::VariableArray::register_python(m);
+
     // Parameter
     eqlib::Parameter::register_python(m);
 
@@ -74,24 +91,57 @@ PYBIND11_MODULE(eqlib, m)
     // LambdaObjective
     eqlib::LambdaObjective::register_python(m);
 
+    // BatchObjective
+    eqlib::BatchObjective::register_python(m);
+
+    // CFunctionConstraint
+    eqlib::CFunctionConstraint::register_python(m);
+
+    // CFunctionObjective
+    eqlib::CFunctionObjective::register_python(m);
+
+    // Future
+    eqlib::Future::register_python(m);
+
     // Problem
     eqlib::Problem::register_python(m);
 
     // Log
     eqlib::Log::register_python(m);
 
+    // Trace
+    eqlib::Trace::register_python(m);
+
     // Node
     eqlib::Node::register_python(m);
 
+    // NodeArray
+    eqlib::NodeArray::register_python(m);
+
     // Timer
     eqlib::Timer::register_python(m);
 
+    // Telemetry
+    eqlib::Telemetry::register_python(m);
+
     // NewtonRaphson
     eqlib::NewtonRaphson::register_python(m);
 
     // SteepestDecent
     eqlib::SteepestDecent::register_python(m);
 
+    // ConjugateGradient
+    eqlib::ConjugateGradient::register_python(m);
+
+    // InteriorPoint
+    eqlib::InteriorPoint::register_python(m);
+
+    // LoadStepping
+    eqlib::LoadStepping::register_python(m);
+
+    // ArcLength
+    eqlib::ArcLength::register_python(m);
+
     // LinearSolver
     eqlib::LinearSolver::register_python(m);
 
@@ -113,6 +163,9 @@ PYBIND11_MODULE(eqlib, m)
     // objectives: IgaNormalDistance
     eqlib::IgaNormalDistanceAD::register_python(m);
 
+    // objectives: IgaMembrane3P
+    eqlib::IgaMembrane3P::register_python(m);
+
     // objectives: IgaMembrane3PAD
     eqlib::IgaMembrane3PAD::register_python(m);
 
@@ -128,6 +181,9 @@ PYBIND11_MODULE(eqlib, m)
     // objectives: IgaRotationCouplingAD
     eqlib::IgaRotationCouplingAD::register_python(m);
 
+    // objectives: IgaShell3P
+    eqlib::IgaShell3P::register_python(m);
+
     // objectives: IgaShell3PAD
     eqlib::IgaShell3PAD::register_python(m);
 }
\ No newline at end of file
@@ -0,0 +1,86 @@
+import eqlib as eq
+
+import numpy as np
+import pytest
+
+from numpy.testing import assert_almost_equal, assert_array_almost_equal, assert_equal
+
+if __name__ == '__main__':
+    import sys
+    import os
+    print(f'pid: {os.getpid()}')
+    pytest.main(sys.argv)
+
+
+class SnapThrough(eq.Objective):
+    # internal force N(x) = x - 1.5 x^2 + 0.5 x^3 with limit points at
+    # x = 1 -+ 1 / sqrt(3)
+
+    def __init__(self, variable, parameter):
+        eq.Objective.__init__(self)
+        self.variables = [variable]
+        self.parameter = parameter
+
+    def compute(self, g, h):
+        x = self.variables[0].value
+        lam = self.parameter.value
+        if len(g) != 0:
+            g[0] = x - 1.5 * x**2 + 0.5 * x**3 - lam
+        if len(h) != 0:
+            h[0, 0] = 1 - 3 * x + 1.5 * x**2
+        return x**2 / 2 - x**3 / 2 + x**4 / 8 - lam * x
+
+
+def internal_force(x):
+    return x - 1.5 * x**2 + 0.5 * x**3
+
+
+def test_snap_through():
+    x = eq.Variable(0.0)
+    load = eq.Parameter(0.0)
+
+    problem = eq.Problem([SnapThrough(x, load)])
+
+    solver = eq.ArcLength(problem, load)
+    solver.step = 0.05
+    solver.max_step = 0.1
+    solver.maxsteps = 200
+    solver.max_parameter = 0.5
+    solver.run()
+
+    assert_equal(solver.stopping_reason, 0)
+    assert_equal(solver.fevals, solver.gevals)
+
+    path_x = solver.path_states[:, 0]
+    path_lambda = solver.path_parameters
+
+    assert_equal(len(path_lambda), solver.nb_points)
+    assert_array_almost_equal(internal_force(path_x), path_lambda)
+
+    # the path passes both limit points
+
+    assert_almost_equal(np.max(path_lambda[path_x < 1]), 1 / (3 * np.sqrt(3)), decimal=2)
+    assert path_x[-1] > 2
+    assert path_lambda[-1] >= 0.5
+
+    assert_equal(solver.path_negative_pivots[0], 0)
+    assert_equal(np.max(solver.path_negative_pivots), 1)
+    assert_equal(solver.path_negative_pivots[-1], 0)
+    assert_equal(len(solver.critical_points), 2)
+
+
+def test_sensitivity():
+    x = eq.Variable(0.0)
+    load = eq.Parameter(0.0)
+
+    problem = eq.Problem([SnapThrough(x, load)])
+
+    solver = eq.ArcLength(problem, load)
+    solver.sensitivity = lambda: np.array([-1.0])
+    solver.psi = 0
+    solver.step = 0.1
+    solver.maxsteps = 10
+    solver.run()
+
+    assert_equal(solver.nb_points, 11)
+    assert_array_almost_equal(internal_force(solver.path_states[:, 0]), solver.path_parameters)
@@ -0,0 +1,139 @@
+import eqlib as eq
+
+import numpy as np
+import pytest
+
+from numpy.testing import assert_almost_equal, assert_equal
+
+if __name__ == '__main__':
+    import sys
+    import os
+    print(f'pid: {os.getpid()}')
+    pytest.main(sys.argv)
+
+
+def compute_springs(x, g, h):
+    # f = 0.5 * (x1 - x0)**2 for each element
+
+    delta = x[:, 1] - x[:, 0]
+
+    if g.size != 0:
+        g[:, 0] = -delta
+        g[:, 1] = delta
+
+    if h.size != 0:
+        h[:] = [[1, -1], [-1, 1]]
+
+    return 0.5 * delta**2
+
+
+def test_batch_objective():
+    x = [eq.Variable(value) for value in [0, 1, 3, 6]]
+
+    batch = eq.BatchObjective([[x[0], x[1]], [x[1], x[2]], [x[2], x[3]]], compute_springs)
+
+    assert_equal(batch.nb_elements, 3)
+    assert_equal(batch.nb_variables, 2)
+
+    problem = eq.Problem(batch.elements, nb_threads=2, grainsize=1)
+
+    problem.compute()
+
+    assert_equal(problem.f, 0.5 * (1 + 4 + 9))
+    assert_equal(problem.df, [-1, -1, -1, 3])
+    assert_equal(problem.hm.toarray(), [[1, -1, 0, 0], [0, 2, -1, 0], [0, 0, 2, -1], [0, 0, 0, 1]])
+
+    x[3].value = 3
+
+    problem.compute(1)
+
+    assert_equal(problem.f, 0.5 * (1 + 4))
+    assert_equal(problem.df, [-1, -1, 2, 0])
+
+
+def test_batch_objective_calls_once():
+    x = [eq.Variable(value) for value in [0, 1, 3]]
+
+    calls = []
+
+    def compute(x, g, h):
+        calls.append(x.shape)
+        return compute_springs(x, g, h)
+
+    batch = eq.BatchObjective([[x[0], x[1]], [x[1], x[2]]], compute)
+
+    problem = eq.Problem(batch.elements)
+
+    problem.compute()
+
+    assert_equal(calls, [(2, 2)])
+
+
+def test_batch_objective_element():
+    x = [eq.Variable(value) for value in [0, 1, 3]]
+
+    batch = eq.BatchObjective([[x[0], x[1]], [x[1], x[2]]], compute_springs)
+
+    batch.compute()
+
+    f, g, h = batch.elements[1].compute_all()
+
+    assert_almost_equal(f, 2)
+    assert_almost_equal(g, [-2, 2])
+    assert_almost_equal(h, [[1, -1], [-1, 1]])
+
+
+def test_batch_objective_checks_sizes():
+    x = [eq.Variable(value) for value in [0, 1, 3]]
+
+    with pytest.raises(ValueError):
+        eq.BatchObjective([[x[0], x[1]], [x[2]]], compute_springs)
+
+    batch = eq.BatchObjective([[x[0], x[1]], [x[1], x[2]]], lambda x, g, h: [1.0])
+
+    with pytest.raises(RuntimeError):
+        batch.compute()
+
+
+def test_batch_objective_zeros_derivatives():
+    x = [eq.Variable(value) for value in [0, 1, 3]]
+
+    def compute(x, g, h):
+        # writes only the diagonal and accumulates into the gradient
+
+        assert_equal(g, 0)
+        assert_equal(h, 0)
+
+        g += 1
+        h[:, 0, 0] = 1
+        h[:, 1, 1] = 1
+
+        return np.zeros(len(x))
+
+    batch = eq.BatchObjective([[x[0], x[1]], [x[1], x[2]]], compute)
+
+    batch.compute()
+    batch.compute()
+
+    f, g, h = batch.elements[0].compute_all()
+
+    assert_equal(g, [1, 1])
+    assert_equal(h, [[1, 0], [0, 1]])
+
+
+def test_batch_objective_arrays_outlive_batch():
+    x = [eq.Variable(value) for value in [0, 1, 3]]
+
+    arrays = []
+
+    def compute(x, g, h):
+        arrays.append(x)
+        return compute_springs(x, g, h)
+
+    batch = eq.BatchObjective([[x[0], x[1]], [x[1], x[2]]], compute)
+
+    batch.compute()
+
+    del batch
+
+    assert_equal(arrays[0], [[0, 1], [1, 3]])
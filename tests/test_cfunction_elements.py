@@ -0,0 +1,136 @@
+import eqlib as eq
+
+import ctypes
+import numpy as np
+import pytest
+
+from numpy.testing import assert_equal
+
+if __name__ == '__main__':
+    import sys
+    import os
+    print(f'pid: {os.getpid()}')
+    pytest.main(sys.argv)
+
+
+c_double_p = ctypes.POINTER(ctypes.c_double)
+
+OBJECTIVE = ctypes.CFUNCTYPE(ctypes.c_double, c_double_p, ctypes.c_ssize_t, c_double_p, c_double_p, ctypes.c_void_p)
+CONSTRAINT = ctypes.CFUNCTYPE(None, c_double_p, ctypes.c_ssize_t, ctypes.c_ssize_t, c_double_p, c_double_p, c_double_p, ctypes.c_void_p)
+
+
+def address(function):
+    return ctypes.cast(function, ctypes.c_void_p).value
+
+
+@OBJECTIVE
+def compute_objective(x, n, g, h, data):
+    # f = scale * (x1**2 + x1 * x2 + x2**3)
+
+    scale = ctypes.cast(data, c_double_p)[0] if data else 1.0
+
+    x1, x2 = x[0], x[1]
+
+    if g:
+        g[0] = scale * (2 * x1 + x2)
+        g[1] = scale * (x1 + 3 * x2**2)
+
+    if h:
+        h[0] = scale * 2
+        h[1] = scale
+        h[2] = scale
+        h[3] = scale * 6 * x2
+
+    return scale * (x1**2 + x1 * x2 + x2**3)
+
+
+@CONSTRAINT
+def compute_constraint(x, n, m, fs, gs, hs, data):
+    # f1 = x1**2 + x1 * x2 + x2**3 and f2 = x1**3 + x1 * x2 + x2**2
+
+    x1, x2 = x[0], x[1]
+
+    fs[0] = x1**2 + x1 * x2 + x2**3
+    fs[1] = x1**3 + x1 * x2 + x2**2
+
+    if gs:
+        for i, value in enumerate([2 * x1 + x2, x1 + 3 * x2**2, 3 * x1**2 + x2, x1 + 2 * x2]):
+            gs[i] = value
+
+    if hs:
+        for i, value in enumerate([2, 1, 1, 6 * x2, 6 * x1, 1, 1, 2]):
+            hs[i] = value
+
+
+def test_cfunction_objective():
+    x1 = eq.Variable(1)
+    x2 = eq.Variable(2)
+
+    element = eq.CFunctionObjective([x1, x2], address(compute_objective))
+
+    f, g, h = element.compute_all()
+
+    assert_equal(f, 11)
+    assert_equal(g, [4, 13])
+    assert_equal(h, [[2, 1], [1, 12]])
+
+
+def test_cfunction_objective_data():
+    x1 = eq.Variable(1)
+    x2 = eq.Variable(2)
+
+    scale = ctypes.c_double(2)
+
+    element = eq.CFunctionObjective([x1, x2], address(compute_objective), ctypes.addressof(scale))
+
+    problem = eq.Problem([element], nb_threads=2)
+
+    problem.compute()
+
+    assert_equal(problem.f, 22)
+    assert_equal(problem.df, [8, 26])
+    assert_equal(problem.hm.toarray(), [[4, 2], [0, 24]])
+
+
+def test_cfunction_constraint():
+    g1 = eq.Equation()
+    g2 = eq.Equation()
+
+    x1 = eq.Variable(1)
+    x2 = eq.Variable(2)
+
+    element = eq.CFunctionConstraint([g1, g2], [x1, x2], address(compute_constraint))
+
+    fs = np.empty(2, float)
+    gs = [np.empty(2, float) for _ in range(2)]
+    hs = [np.empty((2, 2), float) for _ in range(2)]
+
+    element.compute(fs, gs, hs)
+
+    assert_equal(fs, [11, 7])
+    assert_equal(gs, [[4, 13], [5, 5]])
+    assert_equal(hs, [[[2, 1], [1, 12]], [[6, 1], [1, 2]]])
+
+    # empty blocks are passed as null
+
+    element.compute(fs, gs, [np.empty((0, 1), float) for _ in range(2)])
+
+    assert_equal(fs, [11, 7])
+    assert_equal(gs, [[4, 13], [5, 5]])
+
+    problem = eq.Problem([], [element])
+
+    problem.compute()
+
+    assert_equal(problem.g, [11, 7])
+    assert_equal(problem.dg.toarray(), [[4, 13], [5, 5]])
+
+
+def test_null_address_throws():
+    x1 = eq.Variable(1)
+
+    with pytest.raises(ValueError):
+        eq.CFunctionObjective([x1], 0)
+
+    with pytest.raises(ValueError):
+        eq.CFunctionConstraint([eq.Equation()], [x1], 0)
@@ -0,0 +1,99 @@
+import eqlib as eq
+
+import numpy as np
+import pytest
+
+from numpy.testing import assert_almost_equal, assert_equal
+
+if __name__ == '__main__':
+    import sys
+    import os
+    print(f'pid: {os.getpid()}')
+    pytest.main(sys.argv)
+
+
+class Rosenbrock(eq.Objective):
+    def __init__(self, variables):
+        eq.Objective.__init__(self)
+        self.variables = variables
+
+    def compute(self, g, h):
+        x, y = [variable.value for variable in self.variables]
+        if len(g) != 0:
+            g[0] = -2 * (1 - x) - 400 * x * (y - x**2)
+            g[1] = 200 * (y - x**2)
+        if len(h) != 0:
+            h[0, 0] = 2 - 400 * y + 1200 * x**2
+            h[0, 1] = -400 * x
+            h[1, 0] = -400 * x
+            h[1, 1] = 200
+        return (1 - x)**2 + 100 * (y - x**2)**2
+
+
+class Quadratic(eq.Objective):
+    def __init__(self, variables, scales):
+        eq.Objective.__init__(self)
+        self.variables = variables
+        self.scales = np.array(scales, float)
+
+    def compute(self, g, h):
+        x = np.array([variable.value for variable in self.variables])
+        if len(g) != 0:
+            g[:] = self.scales * (x - 1)
+        if len(h) != 0:
+            h[:] = np.diag(self.scales)
+        return 0.5 * np.sum(self.scales * (x - 1)**2)
+
+
+@pytest.mark.parametrize('method', ['fletcher_reeves', 'polak_ribiere', 'hager_zhang'])
+def test_rosenbrock(method):
+    variables = [eq.Variable(-1.2), eq.Variable(1.0)]
+
+    problem = eq.Problem([Rosenbrock(variables)])
+
+    solver = eq.ConjugateGradient(problem)
+    solver.method = method
+    solver.maxiter = 1000
+    solver.xtol = 0
+    solver.run()
+
+    assert_equal(solver.method, method)
+    assert_equal(solver.stopping_reason, 0)
+    assert solver.rnorm < solver.rtol
+    assert_almost_equal(problem.x, [1, 1], decimal=5)
+
+
+def test_preconditioning():
+    scales = np.logspace(0, 4, 20)
+
+    variables = [eq.Variable(0.0) for _ in scales]
+
+    problem = eq.Problem([Quadratic(variables, scales)])
+
+    solver = eq.ConjugateGradient(problem)
+    solver.maxiter = 1000
+    solver.xtol = 0
+    solver.run()
+
+    iterations = solver.iterations
+
+    assert_almost_equal(problem.x, np.ones(20), decimal=5)
+
+    problem.x = np.zeros(20)
+
+    solver.preconditioning = True
+    solver.run()
+
+    assert_almost_equal(problem.x, np.ones(20), decimal=5)
+    assert_equal(solver.fevals, solver.gevals)
+    assert_equal(solver.hevals, 1)
+    assert solver.iterations < iterations
+
+
+def test_invalid_method():
+    problem = eq.Problem([Quadratic([eq.Variable(0.0)], [1])])
+
+    solver = eq.ConjugateGradient(problem)
+
+    with pytest.raises(ValueError):
+        solver.method = 'steepest_decent'
@@ -0,0 +1,117 @@
+import eqlib as eq
+
+import asyncio
+import numpy as np
+import pytest
+import threading
+
+from numpy.testing import assert_almost_equal, assert_equal
+
+if __name__ == '__main__':
+    import sys
+    import os
+    print(f'pid: {os.getpid()}')
+    pytest.main(sys.argv)
+
+
+class BlockingObjective(eq.Objective):
+    def __init__(self, variables):
+        eq.Objective.__init__(self)
+        self.variables = variables
+        self.event = threading.Event()
+
+    def compute(self, g, h):
+        self.event.wait()
+        x1, x2 = [variable.value for variable in self.variables]
+        if len(g) != 0:
+            g[:] = [2 * x1, 4 * x2]
+        if len(h) != 0:
+            h[:] = [[2, 0], [0, 4]]
+        return x1**2 + 2 * x2**2
+
+
+@pytest.fixture
+def element():
+    return BlockingObjective([eq.Variable(1), eq.Variable(2)])
+
+
+def test_compute_async(element):
+    problem = eq.Problem([element])
+
+    future = problem.compute_async()
+
+    assert not future.done()
+    assert problem.is_busy
+
+    with pytest.raises(RuntimeError):
+        problem.x = [3, 4]
+
+    with pytest.raises(RuntimeError):
+        problem.compute()
+
+    with pytest.raises(RuntimeError):
+        problem.compute_async()
+
+    for name, value in [('sigma', 2.0), ('f', 0.0), ('nb_threads', 2), ('grainsize', 1),
+                        ('linear_solver', problem.linear_solver), ('variable_multipliers', [1, 1])]:
+        with pytest.raises(RuntimeError):
+            setattr(problem, name, value)
+
+    with pytest.raises(RuntimeError):
+        problem.invalidate_constant_hessian()
+
+    element.event.set()
+
+    assert future.result() is None
+    assert future.done()
+    assert not problem.is_busy
+
+    assert_equal(problem.f, 9)
+    assert_equal(problem.df, [2, 8])
+
+    problem.x = [3, 4]
+
+
+def test_hm_inv_v_async(element):
+    element.event.set()
+
+    problem = eq.Problem([element])
+
+    problem.compute_async().wait()
+
+    future = problem.hm_inv_v_async([2, 8])
+
+    assert_almost_equal(future.result(), [1, 2])
+
+
+def test_compute_async_raises(element):
+    element.event.set()
+
+    problem = eq.Problem([element])
+
+    with pytest.raises(ValueError):
+        problem.compute_async(3)
+
+    def compute(g, h):
+        raise RuntimeError('failed')
+
+    element.compute = compute
+
+    future = problem.compute_async()
+
+    with pytest.raises(RuntimeError):
+        future.result()
+
+
+def test_await(element):
+    element.event.set()
+
+    problem = eq.Problem([element])
+
+    async def run():
+        await problem.compute_async()
+        return await problem.hm_inv_v_async([2, 8])
+
+    assert_almost_equal(asyncio.run(run()), [1, 2])
+
+    assert_equal(problem.f, 9)
@@ -0,0 +1,51 @@
+import eqlib as eq
+
+import numpy as np
+import pytest
+
+from numpy.testing import assert_almost_equal
+
+from test_iga_shell_3p import DATA, create_elements, create_nodes
+
+if __name__ == '__main__':
+    import sys
+    import os
+    print(f'pid: {os.getpid()}')
+    pytest.main(sys.argv)
+
+
+@pytest.mark.parametrize('curved', [False, True])
+@pytest.mark.parametrize('nb_points', [1, 5])
+def test_compare_with_ad(curved, nb_points):
+    element, element_ad = create_elements([eq.IgaMembrane3P, eq.IgaMembrane3PAD], curved, nb_points)
+
+    f, g, h = element.compute_all()
+    f_ad, g_ad, h_ad = element_ad.compute_all()
+
+    scale = np.max(np.abs(h_ad))
+
+    assert_almost_equal(f, f_ad)
+    assert_almost_equal(np.divide(g, scale), np.divide(g_ad, scale))
+    assert_almost_equal(np.divide(h, scale), np.divide(h_ad, scale))
+
+
+def test_add_many():
+    nodes = create_nodes(True)
+
+    shape_functions = np.array(DATA['shape_functions'])
+    weights = DATA['weight'] * np.arange(1, 6)
+
+    element = eq.IgaMembrane3P(nodes, 1, 100, 0.3)
+    element_many = eq.IgaMembrane3P(nodes, 1, 100, 0.3)
+
+    for weight in weights:
+        element.add(shape_functions, weight)
+
+    element_many.add_many(np.array([shape_functions] * len(weights)), weights)
+
+    f, g, h = element.compute_all()
+    f_many, g_many, h_many = element_many.compute_all()
+
+    assert_almost_equal(f_many, f)
+    assert_almost_equal(g_many, g)
+    assert_almost_equal(h_many, h)
@@ -0,0 +1,66 @@
+import eqlib as eq
+
+import numpy as np
+import pytest
+
+from numpy.testing import assert_almost_equal
+
+from test_iga_shell_3p_ad import DATA, create_nodes
+
+if __name__ == '__main__':
+    import sys
+    import os
+    print(f'pid: {os.getpid()}')
+    pytest.main(sys.argv)
+
+
+@pytest.fixture
+def nodes():
+    return create_nodes()
+
+
+@pytest.fixture
+def element(nodes):
+    element = eq.IgaMembrane3PAD(nodes, 1, 100, 0.3)
+
+    # five points fill one batch and a padded second one
+
+    for i in range(5):
+        element.add(DATA['shape_functions'], DATA['weight'] * (i + 1) / 15)
+
+    return element
+
+
+def test_derivatives(element, nodes):
+    f, g, h = element.compute_all()
+
+    # order 0 evaluates the points one at a time. Compare with central
+    # differences of the pointwise evaluation and the gradient
+
+    problem = eq.Problem([element])
+
+    def f_of_x():
+        problem.compute(0)
+        return problem.f
+
+    assert_almost_equal(f_of_x(), f)
+
+    delta = 1e-6
+
+    variables = [variable for node in nodes for variable in [node.x, node.y, node.z]]
+
+    for i, variable in enumerate(variables):
+        value = variable.value
+
+        variable.value = value + delta
+        f_plus = f_of_x()
+        g_plus = np.array(element.compute_all()[1])
+
+        variable.value = value - delta
+        f_minus = f_of_x()
+        g_minus = np.array(element.compute_all()[1])
+
+        variable.value = value
+
+        assert_almost_equal(g[i], (f_plus - f_minus) / (2 * delta), decimal=5)
+        assert_almost_equal(h[i], (g_plus - g_minus) / (2 * delta), decimal=4)
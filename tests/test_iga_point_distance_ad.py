@@ -56,3 +56,30 @@ def test_element(element):
     assert_almost_equal(f, DATA['exp_f'])
     assert_almost_equal(g, DATA['exp_g'])
     assert_almost_equal(np.triu(h), np.triu(DATA['exp_h']))
+
+
+@pytest.mark.parametrize('nb_nodes_a, nb_nodes_b', [(9, 9), (9, 16), (16, 16), (4, 16), (4, 6)])
+def test_nb_nodes(nb_nodes_a, nb_nodes_b):
+    # compare the specializations for fixed numbers of nodes with the
+    # element without automatic differentiation
+
+    np.random.seed(nb_nodes_a * 100 + nb_nodes_b)
+
+    nodes_a = [eq.Node(*np.random.rand(3)) for _ in range(nb_nodes_a)]
+    nodes_b = [eq.Node(*np.random.rand(3)) for _ in range(nb_nodes_b)]
+
+    shape_functions_a = np.random.rand(1, nb_nodes_a)
+    shape_functions_b = np.random.rand(1, nb_nodes_b)
+
+    element = eq.IgaPointDistanceAD(nodes_a, nodes_b)
+    element.add(shape_functions_a, shape_functions_b, 2.5)
+
+    expected = eq.IgaPointDistance(nodes_a, nodes_b)
+    expected.add(shape_functions_a, shape_functions_b, 2.5)
+
+    f, g, h = element.compute_all()
+    exp_f, exp_g, exp_h = expected.compute_all()
+
+    assert_almost_equal(f, exp_f)
+    assert_almost_equal(g, exp_g)
+    assert_almost_equal(np.triu(h), np.triu(exp_h))
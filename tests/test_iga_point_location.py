@@ -1,5 +1,6 @@
 import eqlib as eq
 
+import numpy as np
 import pytest
 
 from numpy.testing import assert_almost_equal
@@ -50,3 +51,18 @@ def test_element(element):
     assert_almost_equal(f, DATA['exp_f'])
     assert_almost_equal(g, DATA['exp_g'])
     assert_almost_equal(h, DATA['exp_h'])
+
+
+def test_add_checks_shape_functions(element):
+    shape_functions = DATA['shape_functions']
+
+    with pytest.raises(ValueError):
+        element.add([row[:-1] for row in shape_functions], DATA['target'], DATA['weight'])
+
+    element.add(shape_functions, DATA['target'], DATA['weight'])
+
+    f, g, h = element.compute_all()
+
+    assert_almost_equal(f, 2 * np.array(DATA['exp_f']))
+    assert_almost_equal(g, 2 * np.array(DATA['exp_g']))
+    assert_almost_equal(h, 2 * np.array(DATA['exp_h']))
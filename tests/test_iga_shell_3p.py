@@ -0,0 +1,64 @@
+import eqlib as eq
+
+import numpy as np
+import pytest
+
+from numpy.testing import assert_almost_equal
+
+from test_iga_shell_3p_ad import DATA
+
+if __name__ == '__main__':
+    import sys
+    import os
+    print(f'pid: {os.getpid()}')
+    pytest.main(sys.argv)
+
+
+def create_nodes(curved):
+    # the curved reference geometry has a nonzero reference curvature
+
+    nodes = []
+    for ref_location, act_location in zip(DATA['ref_locations'], DATA['act_locations']):
+        ref_location = np.array(ref_location)
+        if curved:
+            ref_location[2] = 0.1 * ref_location[0] * ref_location[1] - 0.02 * ref_location[0]**2
+        node = eq.Node()
+        node.ref_location = ref_location
+        node.act_location = act_location
+        nodes.append(node)
+    return nodes
+
+
+def create_elements(element_types, curved, nb_points):
+    nodes = create_nodes(curved)
+    elements = [element_type(nodes, 1, 100, 0.3) for element_type in element_types]
+    for element in elements:
+        for i in range(nb_points):
+            element.add(DATA['shape_functions'], DATA['weight'] * (i + 1))
+    return elements
+
+
+@pytest.mark.parametrize('curved', [False, True])
+@pytest.mark.parametrize('nb_points', [1, 5])
+def test_compare_with_ad(curved, nb_points):
+    element, element_ad = create_elements([eq.IgaShell3P, eq.IgaShell3PAD], curved, nb_points)
+
+    f, g, h = element.compute_all()
+    f_ad, g_ad, h_ad = element_ad.compute_all()
+
+    scale = np.max(np.abs(h_ad))
+
+    assert_almost_equal(f, f_ad)
+    assert_almost_equal(np.divide(g, scale), np.divide(g_ad, scale))
+    assert_almost_equal(np.divide(h, scale), np.divide(h_ad, scale))
+
+
+def test_element():
+    element = eq.IgaShell3P(create_nodes(False), 1, 100, 0)
+    element.add(DATA['shape_functions'], DATA['weight'])
+
+    f, g, h = element.compute_all()
+
+    assert_almost_equal(f, DATA['exp_f'])
+    assert_almost_equal(g, DATA['exp_g'])
+    assert_almost_equal(np.triu(h), np.triu(DATA['exp_h']))
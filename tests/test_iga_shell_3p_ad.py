@@ -3,7 +3,7 @@ import eqlib as eq
 import numpy as np
 import pytest
 
-from numpy.testing import assert_almost_equal
+from numpy.testing import assert_almost_equal, assert_equal
 
 if __name__ == '__main__':
     import sys
@@ -30,14 +30,19 @@ DATA = {
 }
 
 
-@pytest.fixture
-def element():
+def create_nodes():
     nodes = []
     for ref_location, act_location in zip(DATA['ref_locations'], DATA['act_locations']):
         node = eq.Node()
         node.ref_location = ref_location
         node.act_location = act_location
         nodes.append(node)
+    return nodes
+
+
+@pytest.fixture
+def element():
+    nodes = create_nodes()
 
     shape_functions = DATA['shape_functions']
 
@@ -55,3 +60,70 @@ def test_element(element):
     assert_almost_equal(f, DATA['exp_f'])
     assert_almost_equal(g, DATA['exp_g'])
     assert_almost_equal(np.triu(h), np.triu(DATA['exp_h']))
+
+
+def test_batched_points():
+    # five points fill one batch and a padded second one
+
+    element = eq.IgaShell3PAD(create_nodes(), 1, 100, 0)
+
+    for _ in range(5):
+        element.add(DATA['shape_functions'], DATA['weight'] / 5)
+
+    f, g, h = element.compute_all()
+
+    assert_almost_equal(f, DATA['exp_f'])
+    assert_almost_equal(g, DATA['exp_g'])
+    assert_almost_equal(np.triu(h), np.triu(DATA['exp_h']))
+
+    # order 0 evaluates the points one at a time
+
+    problem = eq.Problem([element])
+    problem.compute(0)
+
+    assert_almost_equal(problem.f, f)
+
+
+def test_add_many():
+    nodes = create_nodes()
+
+    shape_functions = np.array(DATA['shape_functions'])
+    weights = DATA['weight'] * np.arange(1, 6) / 15
+
+    element = eq.IgaShell3PAD(nodes, 1, 100, 0)
+    element_many = eq.IgaShell3PAD(nodes, 1, 100, 0)
+
+    for weight in weights:
+        element.add(shape_functions, weight)
+
+    # additional rows are ignored
+
+    stacked = np.array([np.vstack([shape_functions, np.ones(len(nodes))]) for _ in weights])
+
+    assert_equal(element_many.add_many(stacked, weights), 0)
+    assert_equal(element_many.add_many(stacked[:2], weights[:2]), 5)
+
+    element.add(shape_functions, weights[0])
+    element.add(shape_functions, weights[1])
+
+    f, g, h = element.compute_all()
+    f_many, g_many, h_many = element_many.compute_all()
+
+    assert_equal(f_many, f)
+    assert_equal(g_many, g)
+    assert_equal(h_many, h)
+
+
+def test_add_many_checks_shape():
+    element = eq.IgaShell3PAD(create_nodes(), 1, 100, 0)
+
+    shape_functions = np.array([DATA['shape_functions']])
+
+    with pytest.raises(ValueError):
+        element.add_many(shape_functions[:, :5], [1.0])
+
+    with pytest.raises(ValueError):
+        element.add_many(shape_functions[:, :, 1:], [1.0])
+
+    with pytest.raises(ValueError):
+        element.add_many(shape_functions, [1.0, 2.0])
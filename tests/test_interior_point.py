@@ -0,0 +1,100 @@
+import eqlib as eq
+
+import numpy as np
+import pytest
+
+from numpy.testing import assert_almost_equal, assert_equal
+
+if __name__ == '__main__':
+    import sys
+    import os
+    print(f'pid: {os.getpid()}')
+    pytest.main(sys.argv)
+
+
+class Distance(eq.Objective):
+    def __init__(self, variables, target):
+        eq.Objective.__init__(self)
+        self.variables = variables
+        self.target = np.array(target, float)
+
+    def compute(self, g, h):
+        x = np.array([variable.value for variable in self.variables])
+        delta = x - self.target
+        if len(g) != 0:
+            g[:] = 2 * delta
+        if len(h) != 0:
+            h[:] = 2 * np.eye(len(x))
+        return delta @ delta
+
+
+class Sum(eq.Constraint):
+    def __init__(self, equation, variables):
+        eq.Constraint.__init__(self)
+        self.equations = [equation]
+        self.variables = variables
+
+    def compute(self, fs, gs, hs):
+        fs[0] = sum(variable.value for variable in self.variables)
+        if len(gs[0]) != 0:
+            gs[0][:] = 1
+        if len(hs[0]) != 0:
+            hs[0][:] = 0
+
+
+def test_unconstrained():
+    x1 = eq.Variable(0.0)
+    x2 = eq.Variable(0.0)
+
+    problem = eq.Problem([Distance([x1, x2], [2, 3])])
+
+    solver = eq.InteriorPoint(problem)
+    solver.run()
+
+    assert_equal(solver.stopping_reason, 0)
+    assert_almost_equal(problem.x, [2, 3])
+
+
+def test_variable_bounds():
+    x1 = eq.Variable(0.5, lower_bound=0, upper_bound=1)
+    x2 = eq.Variable(0.0, lower_bound=-1)
+
+    problem = eq.Problem([Distance([x1, x2], [2, -3])])
+
+    solver = eq.InteriorPoint(problem)
+    solver.run()
+
+    assert_equal(solver.stopping_reason, 0)
+    assert_almost_equal(problem.x, [1, -1], decimal=6)
+    assert_almost_equal(solver.z_upper, [2, 0], decimal=6)
+    assert_almost_equal(solver.z_lower, [0, 4], decimal=6)
+
+
+def test_equality_constraint():
+    x1 = eq.Variable(0.0)
+    x2 = eq.Variable(0.0)
+    g = eq.Equation(lower_bound=1, upper_bound=1)
+
+    problem = eq.Problem([Distance([x1, x2], [2, 2])], [Sum(g, [x1, x2])])
+
+    solver = eq.InteriorPoint(problem)
+    solver.run()
+
+    assert_equal(solver.stopping_reason, 0)
+    assert_almost_equal(problem.x, [0.5, 0.5])
+    assert_almost_equal(g.multiplier, 3)
+
+
+def test_inequality_constraint():
+    x1 = eq.Variable(0.0, lower_bound=0, upper_bound=1)
+    x2 = eq.Variable(0.0)
+    g = eq.Equation(upper_bound=2.5)
+
+    problem = eq.Problem([Distance([x1, x2], [2, 2])], [Sum(g, [x1, x2])])
+
+    solver = eq.InteriorPoint(problem)
+    solver.run()
+
+    assert_equal(solver.stopping_reason, 0)
+    assert_almost_equal(problem.x, [1, 1.5], decimal=6)
+    assert_almost_equal(g.multiplier, 1, decimal=6)
@@ -0,0 +1,131 @@
+import eqlib as eq
+
+import numpy as np
+import pytest
+
+from numpy.testing import assert_almost_equal, assert_equal
+
+if __name__ == '__main__':
+    import sys
+    import os
+    print(f'pid: {os.getpid()}')
+    pytest.main(sys.argv)
+
+
+class Spring(eq.Objective):
+    # f = k x^2 / 2 + x^4 / 4 - lambda * x
+
+    def __init__(self, variable, parameter, k=1.0):
+        eq.Objective.__init__(self)
+        self.variables = [variable]
+        self.parameter = parameter
+        self.k = k
+
+    def compute(self, g, h):
+        x = self.variables[0].value
+        lam = self.parameter.value
+        if len(g) != 0:
+            g[0] = self.k * x + x**3 - lam
+        if len(h) != 0:
+            h[0, 0] = self.k + 3 * x**2
+        return self.k * x**2 / 2 + x**4 / 4 - lam * x
+
+
+def solution(lam, k=1.0):
+    roots = np.roots([1, 0, k, -lam])
+    return roots[np.abs(roots.imag) < 1e-10].real[0]
+
+
+def test_schedule():
+    x = eq.Variable(0.0)
+    load = eq.Parameter(0.0)
+
+    problem = eq.Problem([Spring(x, load)])
+
+    solver = eq.LoadStepping(problem, load, schedule=[1.0, 5.0, 10.0])
+    solver.run()
+
+    assert_equal(solver.stopping_reason, 0)
+    assert_almost_equal(load.value, 10.0)
+    assert_almost_equal(x.value, solution(10.0))
+    assert_equal(solver.fevals, solver.gevals)
+
+    assert_equal(len(solver.step_parameters), solver.nb_steps)
+    assert_equal(len(solver.step_iterations), solver.nb_steps)
+    assert_equal(len(solver.step_times), solver.nb_steps)
+    assert_almost_equal(solver.step_parameters[-1], 10.0)
+    assert_almost_equal(np.sum(solver.step_sizes), 10.0)
+
+    for value in [1.0, 5.0]:
+        assert value in solver.step_parameters
+
+
+def test_predictor_reduces_iterations():
+    x = eq.Variable(0.0)
+    load = eq.Parameter(0.0)
+
+    problem = eq.Problem([Spring(x, load)])
+
+    solver = eq.LoadStepping(problem, load, schedule=np.linspace(1, 10, 10))
+    solver.max_step = 1.0
+    solver.run()
+
+    with_predictor = np.sum(solver.step_iterations)
+
+    x.value = 0.0
+    load.value = 0.0
+
+    solver.predictor = False
+    solver.run()
+
+    without_predictor = np.sum(solver.step_iterations)
+
+    assert_almost_equal(x.value, solution(10.0))
+    assert with_predictor < without_predictor
+
+
+def test_sensitivity():
+    x = eq.Variable(0.0)
+    load = eq.Parameter(0.0)
+
+    problem = eq.Problem([Spring(x, load)])
+
+    solver = eq.LoadStepping(problem, load, schedule=[10.0])
+    solver.sensitivity = lambda: np.array([-1.0])
+    solver.run()
+
+    assert_equal(solver.stopping_reason, 0)
+    assert_almost_equal(x.value, solution(10.0))
+
+
+def test_cutback():
+    x = eq.Variable(0.0)
+    load = eq.Parameter(0.0)
+
+    problem = eq.Problem([Spring(x, load)])
+
+    solver = eq.LoadStepping(problem, load, schedule=[100.0])
+    solver.maxiter = 5
+    solver.run()
+
+    assert_equal(solver.stopping_reason, 0)
+    assert_almost_equal(x.value, solution(100.0))
+    assert np.sum(solver.step_cutbacks) > 0
+
+
+def test_schedule_starts_at_current_value():
+    x = eq.Variable(0.0)
+    load = eq.Parameter(0.0)
+
+    problem = eq.Problem([Spring(x, load)])
+
+    solver = eq.LoadStepping(problem, load, schedule=[0.0, 5.0, 5.0, 10.0])
+    solver.run()
+
+    assert_equal(solver.stopping_reason, 0)
+    assert_almost_equal(x.value, solution(10.0))
+
+    solver.max_step = 0.0
+
+    with pytest.raises(ValueError):
+        solver.run()
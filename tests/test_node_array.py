@@ -0,0 +1,55 @@
+import eqlib as eq
+
+import numpy as np
+import pytest
+
+from numpy.testing import assert_equal
+
+if __name__ == '__main__':
+    import sys
+    import os
+    print(f'pid: {os.getpid()}')
+    pytest.main(sys.argv)
+
+
+@pytest.fixture
+def nodes():
+    return eq.NodeArray([[1, 2, 3], [4, 5, 6]])
+
+
+def test_init(nodes):
+    assert_equal(len(nodes), 2)
+
+    assert_equal(nodes[1].ref_location, [4, 5, 6])
+    assert_equal(nodes[1].act_location, [4, 5, 6])
+
+    assert_equal(nodes.ref_locations, [[1, 2, 3], [4, 5, 6]])
+    assert_equal(nodes.act_locations, [[1, 2, 3], [4, 5, 6]])
+
+
+def test_views(nodes):
+    nodes.act_locations[0] = [2, 2, 2]
+
+    assert_equal(nodes[0].act_location, [2, 2, 2])
+    assert_equal(nodes.displacements, [[1, 0, -1], [0, 0, 0]])
+
+    nodes[1].act_location = [5, 5, 5]
+
+    assert_equal(nodes.act_variables.values, [2, 2, 2, 5, 5, 5])
+
+    nodes.displacements = np.ones((2, 3))
+
+    assert_equal(nodes.act_locations, [[2, 3, 4], [5, 6, 7]])
+
+    with pytest.raises(ValueError):
+        nodes.act_locations = np.ones((3, 3))
+
+
+def test_elements(nodes):
+    element = eq.IgaPointLocation(nodes.nodes)
+
+    element.add([[0.5, 0.5]], [0, 0, 0], 1)
+
+    f, g, h = element.compute_all()
+
+    assert_equal(f, 0.5 * (2.5**2 + 3.5**2 + 4.5**2))
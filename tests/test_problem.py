@@ -3,7 +3,7 @@ import eqlib as eq
 import numpy as np
 import pytest
 
-from numpy.testing import assert_equal
+from numpy.testing import assert_almost_equal, assert_equal
 
 if __name__ == '__main__':
     import sys
@@ -62,6 +62,53 @@ def test_variable_index(problem):
         assert_equal(problem.variable_index(variable), i)
 
 
+def test_variable_index_shared_variables(problem):
+    x1, x2, x3 = problem.variables
+
+    other = eq.Problem([ConstantObjective([x3, x1], 1, [2, 3], np.eye(2))])
+
+    for i, variable in enumerate(problem.variables):
+        assert_equal(problem.variable_index(variable), i)
+
+    assert_equal(other.variable_index(x3), 0)
+    assert_equal(other.variable_index(x1), 1)
+    assert_equal(other.variable_index(x2), -1)
+    assert_equal(problem.variable_index(eq.Variable()), -1)
+
+
+def test_duplicate_variables():
+    x1 = eq.Variable(value=2.0)
+    x2 = eq.Variable(value=7.0)
+
+    elements = [
+        ConstantObjective([x1, x2], 1, [2, 3], np.eye(2)),
+        ConstantObjective([x2, x1], 1, [2, 3], np.eye(2)),
+        ConstantObjective([x2], 1, [2], np.eye(1)),
+    ]
+
+    problem = eq.Problem(elements)
+
+    assert_equal(problem.nb_variables, 2)
+    assert_equal(problem.variable_index(x1), 0)
+    assert_equal(problem.variable_index(x2), 1)
+
+
+def test_variable_order_parallel():
+    np.random.seed(1)
+
+    variables = [eq.Variable(is_active=i % 7 != 0) for i in range(200)]
+
+    elements = [ConstantObjective([variables[j] for j in np.random.choice(200, 4, replace=False)], 0, np.zeros(4), np.zeros((4, 4))) for _ in range(300)]
+
+    serial = eq.Problem(elements)
+    parallel = eq.Problem(elements, nb_threads=4, grainsize=1)
+
+    assert parallel.variables == serial.variables
+
+    assert_equal(parallel.hm_indptr, serial.hm_indptr)
+    assert_equal(parallel.hm_indices, serial.hm_indices)
+
+
 def test_nb_elements_f(problem):
     assert_equal(problem.nb_elements_f, 2)
 
@@ -78,6 +125,111 @@ def test_compute(problem):
     assert_equal(problem.hm.toarray(), [[4, -5.6, 0], [0, 4.2, 6], [0, 0, 11.3]])
 
 
+def test_sparse_views(problem):
+    problem.compute()
+
+    hm = problem.hm
+    hm_view = problem.hm_view
+
+    assert not np.shares_memory(hm.data, problem.hm_values)
+    assert np.shares_memory(hm_view.data, problem.hm_values)
+    assert np.shares_memory(problem.hm_indptr, problem.hm_indptr)
+
+    assert_equal(problem.hm_indptr, [0, 2, 4, 5])
+    assert_equal(problem.hm_indices, [0, 1, 1, 2, 2])
+
+    with pytest.raises(ValueError):
+        problem.hm_indices[0] = 1
+
+    hm_of = problem.hm_of(problem.x)
+
+    assert_equal(hm_of.toarray(), hm.toarray())
+
+    # only the view shows the results of later changes
+
+    problem.scale(2)
+
+    assert_equal(hm.toarray(), [[4, -5.6, 0], [0, 4.2, 6], [0, 0, 11.3]])
+    assert_equal(hm_of.toarray(), [[4, -5.6, 0], [0, 4.2, 6], [0, 0, 11.3]])
+    assert_equal(hm_view.toarray(), [[8, -11.2, 0], [0, 8.4, 12], [0, 0, 22.6]])
+
+
+def test_evaluation_cache():
+    class CountingObjective(eq.Objective):
+        def __init__(self, variables):
+            eq.Objective.__init__(self)
+            self.variables = variables
+            self.calls = 0
+
+        def compute(self, g, h):
+            self.calls += 1
+            x1, x2 = [variable.value for variable in self.variables]
+            if len(g) != 0:
+                g[:] = [2 * x1, 3 * x2**2]
+            if len(h) != 0:
+                h[:] = [[2, 0], [0, 6 * x2]]
+            return x1**2 + x2**3
+
+    element = CountingObjective([eq.Variable(1), eq.Variable(2)])
+
+    problem = eq.Problem([element])
+
+    f, df = problem.fdf_of([2, 1])
+
+    assert_equal(f, 5)
+    assert_equal(df, [4, 3])
+    assert_equal(element.calls, 1)
+
+    assert_equal(problem.f_of([2, 1]), 5)
+    assert_equal(problem.df_of([2, 1]), [4, 3])
+    assert_equal(element.calls, 1)
+
+    assert_equal(problem.hm_of([2, 1]).toarray(), [[2, 0], [0, 6]])
+    assert_equal(element.calls, 2)
+
+    assert_equal(problem.f_of([1, 1]), 2)
+    assert_equal(element.calls, 3)
+
+    problem.variables[0].value = 3
+
+    assert_equal(problem.f_of([1, 1]), 2)
+    assert_equal(element.calls, 4)
+
+    problem.invalidate_cache()
+
+    assert_equal(problem.f_of([1, 1]), 2)
+    assert_equal(element.calls, 5)
+
+    with pytest.raises(RuntimeError):
+        problem.f_of([1, 1, 1])
+
+    assert_equal(element.calls, 5)
+
+
+def test_remove_inactive_elements():
+    x1 = eq.Variable(value=2.0)
+    x2 = eq.Variable(value=7.0)
+    x3 = eq.Variable(value=9.0)
+
+    elements = [
+        ConstantObjective([x1, x2], 1, [2, 3], [[4, -5.6], [-5.6, 6.2]]),
+        ConstantObjective([x2, x3], 3, [5.1, 7], [[-2, 6], [6, 11.3]]),
+    ]
+
+    problem = eq.Problem(elements)
+
+    elements[0].is_active = False
+    problem.remove_inactive_elements()
+
+    assert_equal(problem.nb_elements_f, 1)
+
+    problem.compute()
+
+    assert_equal(problem.f, 3)
+    assert_equal(problem.df, [0, 5.1, 7])
+    assert_equal(problem.hm.toarray(), [[0, 0, 0], [0, -2, 6], [0, 0, 11.3]])
+
+
 def test_compute_0(problem):
     problem.df.fill(0)
     problem.hm_values.fill(0)
@@ -107,6 +259,131 @@ def test_compute_2(problem):
     assert_equal(problem.hm.toarray(), [[4, -5.6, 0], [0, 4.2, 6], [0, 0, 11.3]])
 
 
+def test_compute_constant_hessian():
+    x1 = eq.Variable(name='x1', value=2.0)
+    x2 = eq.Variable(name='x2', value=7.0)
+    x3 = eq.Variable(name='x3', value=9.0)
+
+    nb_hessians = [0]
+
+    class CountingObjective(ConstantObjective):
+        def compute(self, g, h):
+            if len(h) != 0:
+                nb_hessians[0] += 1
+            return ConstantObjective.compute(self, g, h)
+
+    element_a = CountingObjective([x1, x2], 1, [2, 3], [[4, -5.6], [-5.6, 6.2]])
+    element_b = CountingObjective([x2, x3], 3, [5.1, 7], [[-2, 6], [6, 11.3]])
+
+    element_a.constant_hessian = True
+
+    problem = eq.Problem([element_a, element_b])
+    problem.sigma = 2
+
+    for _ in range(3):
+        problem.compute(2)
+
+        assert_equal(problem.f, 8)
+        assert_equal(problem.df, np.multiply([2, 8.1, 7], 2))
+        assert_equal(problem.hm.toarray(), np.multiply([[4, -5.6, 0], [0, 4.2, 6], [0, 0, 11.3]], 2))
+
+    assert_equal(nb_hessians[0], 1 + 3)
+
+    # the cached hessian follows the active state of the element
+
+    element_a.is_active = False
+
+    problem.compute(2)
+
+    assert_equal(problem.hm.toarray(), np.multiply([[0, 0, 0], [0, -2, 6], [0, 0, 11.3]], 2))
+
+    element_a.is_active = True
+    element_a.h = np.multiply(element_a.h, 2)
+
+    problem.invalidate_constant_hessian()
+    problem.compute(2)
+
+    assert_equal(problem.hm.toarray(), np.multiply([[8, -11.2, 0], [0, 10.4, 6], [0, 0, 11.3]], 2))
+
+
+def test_constant_hessian_follows_revision():
+    node = eq.Node(1, 2, 3)
+
+    element = eq.IgaPointLocation([node])
+    element.add([[1.0]], [0, 0, 0], 1)
+
+    problem = eq.Problem([element])
+    problem.compute(2)
+
+    assert_equal(problem.hm.toarray(), np.eye(3))
+
+    # adding a point changes the hessian of the element
+
+    revision = element.revision
+
+    element.add([[1.0]], [1, 1, 1], 2)
+
+    assert_equal(element.revision, revision + 1)
+
+    problem.compute(2)
+
+    assert_equal(problem.hm.toarray(), 3 * np.eye(3))
+
+
+def test_gathered_node_locations(tmp_path):
+    node_1 = eq.Node(1, 2, 3)
+    node_2 = eq.Node(4, 5, 6)
+
+    element_a = eq.IgaPointLocation([node_1, node_2])
+    element_a.add([[0.25, 0.75]], [1, 1, 1], 2)
+
+    element_b = eq.IgaPointLocation([node_2, node_1])
+    element_b.add([[0.5, 0.5]], [3, 2, 1], 1)
+
+    def check(problem):
+        problem.compute(1)
+
+        f_a, g_a, _ = element_a.compute_all()
+        f_b, g_b, _ = element_b.compute_all()
+
+        assert_almost_equal(problem.f, f_a + f_b)
+        assert_almost_equal(problem.df, g_a + np.roll(g_b, 3))
+
+    problem = eq.Problem([element_a, element_b])
+
+    check(problem)
+
+    # the locations are gathered again for each computation
+
+    problem.x = problem.x + 1
+
+    check(problem)
+
+    path = str(tmp_path / 'problem.bin')
+
+    problem.save(path)
+
+    check(eq.Problem.load(path, [element_a, element_b]))
+
+    with pytest.raises(RuntimeError):
+        eq.Problem.load(path, [element_a, eq.IgaPointLocation([node_2, eq.Node()])])
+
+    # owned values are gathered from the problem. Inactive variables are
+    # not part of it and are read through the nodes
+
+    node_1.x.is_active = False
+
+    problem = eq.Problem([element_a, element_b])
+    problem.owns_variables = True
+
+    problem.x = problem.x + 1
+    node_1.x.value = 7
+
+    problem.compute(0)
+
+    assert_almost_equal(problem.f, element_a.compute_all()[0] + element_b.compute_all()[0])
+
+
 def test_compute_invalid_order_throws(problem):
     with pytest.raises(ValueError) as ex:
         problem.compute(-1)
@@ -155,3 +432,135 @@ def test_scale(problem):
     assert_equal(problem.f, 4 * 1.5)
     assert_equal(problem.df, np.multiply([2, 8.1, 7], 1.5))
     assert_equal(problem.hm.toarray(), np.multiply([[4, -5.6, 0], [0, 4.2, 6], [0, 0, 11.3]], 1.5))
+
+
+def test_owns_variables(problem):
+    x1, x2, x3 = problem.variables
+
+    assert not problem.owns_variables
+
+    problem.owns_variables = True
+
+    assert problem.owns_variables
+    assert_equal(problem.x, [2, 7, 9])
+
+    problem.x = [1, 2, 3]
+
+    assert_equal(x2.value, 2)
+
+    x3.value = 5
+    x3.lower_bound = -1
+
+    assert_equal(problem.x, [1, 2, 5])
+    assert_equal(problem.variable_bounds[2], (-1, np.inf))
+
+    problem.add_x([1, 1, 1])
+    problem.sub_x([0.5, 0.5, 0.5])
+
+    assert_equal(problem.x, [1.5, 2.5, 5.5])
+
+    problem.variable_multipliers = [4, 5, 6]
+
+    assert_equal(x1.multiplier, 4)
+
+    problem.compute()
+
+    assert_equal(problem.df, [2, 8.1, 7])
+
+    problem.owns_variables = False
+
+    assert_equal(x1.value, 1.5)
+    assert_equal(x3.value, 5.5)
+    assert_equal(x3.lower_bound, -1)
+    assert_equal(problem.variable_multipliers, [4, 5, 6])
+
+
+def test_owned_variables_outlive_problem():
+    x1 = eq.Variable(value=2.0)
+    x2 = eq.Variable(value=7.0)
+
+    problem = eq.Problem([ConstantObjective([x1, x2], 1, [2, 3], [[4, -5.6], [-5.6, 6.2]])])
+    problem.owns_variables = True
+    problem.x = [3, 4]
+
+    del problem
+
+    assert_equal(x1.value, 3)
+    assert_equal(x2.value, 4)
+
+
+def test_variables_owned_once(problem):
+    problem.owns_variables = True
+
+    other = eq.Problem([ConstantObjective(problem.variables, 1, [2, 3, 4], np.eye(3))])
+
+    with pytest.raises(RuntimeError):
+        other.owns_variables = True
+
+    clone = problem.clone()
+
+    assert not clone.owns_variables
+
+    clone.x = [0, 0, 0]
+
+    assert_equal(problem.x, [0, 0, 0])
+
+
+def test_save_load(tmp_path):
+    class Sum(eq.Constraint):
+        def __init__(self, equation, variables):
+            eq.Constraint.__init__(self)
+            self.equations = [equation]
+            self.variables = variables
+
+        def compute(self, fs, gs, hs):
+            fs[0] = sum(variable.value for variable in self.variables)
+            if len(gs[0]) != 0:
+                gs[0][:] = 1
+
+    x1 = eq.Variable(value=2.0)
+    x2 = eq.Variable(value=7.0)
+    x3 = eq.Variable(value=9.0)
+    x4 = eq.Variable(value=1.0, is_active=False)
+
+    objective = [
+        ConstantObjective([x3, x1], 1, [2, 3], [[4, -5.6], [-5.6, 6.2]]),
+        ConstantObjective([x2, x4, x3], 3, [5.1, 0, 7], [[-2, 0, 6], [0, 0, 0], [6, 0, 11.3]]),
+    ]
+
+    constraints = [Sum(eq.Equation(), [x2, x1])]
+
+    problem = eq.Problem(objective, constraints)
+    problem.compute()
+
+    path = str(tmp_path / 'problem.bin')
+
+    problem.save(path)
+
+    loaded = eq.Problem.load(path, objective, constraints)
+    loaded.compute()
+
+    assert loaded.variables == problem.variables
+    assert loaded.equations == problem.equations
+
+    assert_equal(loaded.hm_indptr, problem.hm_indptr)
+    assert_equal(loaded.hm_indices, problem.hm_indices)
+    assert_equal(loaded.dg_indptr, problem.dg_indptr)
+    assert_equal(loaded.dg_indices, problem.dg_indices)
+
+    assert_equal(loaded.f, problem.f)
+    assert_equal(loaded.df, problem.df)
+    assert_equal(loaded.g, problem.g)
+    assert_equal(loaded.hm_values, problem.hm_values)
+    assert_equal(loaded.dg_values, problem.dg_values)
+
+    with pytest.raises(RuntimeError):
+        eq.Problem.load(path, objective[:1], constraints)
+
+    with pytest.raises(RuntimeError):
+        eq.Problem.load(path, objective[::-1], constraints)
+
+    x4.is_active = True
+
+    with pytest.raises(RuntimeError):
+        eq.Problem.load(path, objective, constraints)
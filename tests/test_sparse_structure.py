@@ -59,6 +59,16 @@ def test_csr_square(csr_square):
     assert_equal(structure.density, 7 / 16)
 
 
+def test_csr_index_views(csr_rectangular):
+    structure = csr_rectangular
+
+    assert isinstance(structure.ia, np.ndarray)
+    assert np.shares_memory(structure.ja, structure.ja)
+
+    with pytest.raises(ValueError):
+        structure.ja[0] = 1
+
+
 def test_csr_convert_from(csr_rectangular):
     a = np.array([0, 1, 2, 3, 4, 5], float)
 
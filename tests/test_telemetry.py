@@ -0,0 +1,146 @@
+import eqlib as eq
+
+import json
+import numpy as np
+import pytest
+
+from numpy.testing import assert_almost_equal, assert_equal
+
+if __name__ == '__main__':
+    import sys
+    import os
+    print(f'pid: {os.getpid()}')
+    pytest.main(sys.argv)
+
+
+class Quartic(eq.Objective):
+    def __init__(self, variables):
+        eq.Objective.__init__(self)
+        self.variables = variables
+
+    def compute(self, g, h):
+        x = np.array([variable.value for variable in self.variables])
+        if len(g) != 0:
+            g[:] = 4 * (x - 1)**3 + (x - 1)
+        if len(h) != 0:
+            h[:] = np.diag(12 * (x - 1)**2 + 1)
+        return np.sum((x - 1)**4 + 0.5 * (x - 1)**2)
+
+
+def create_problem():
+    variables = [eq.Variable(0.0), eq.Variable(3.0)]
+    return eq.Problem([Quartic(variables)])
+
+
+@pytest.mark.parametrize('solver_type', [eq.NewtonRaphson, eq.SteepestDecent, eq.ConjugateGradient])
+def test_history(solver_type):
+    problem = create_problem()
+
+    solver = solver_type(problem)
+    solver.xtol = 0
+    solver.run()
+
+    telemetry = solver.telemetry
+
+    assert_equal(solver.stopping_reason, 0)
+    assert_equal(len(telemetry), solver.iterations + 1)
+    assert_almost_equal(telemetry.rnorm[-1], solver.rnorm)
+    assert telemetry.rnorm[-1] < solver.rtol
+    assert np.all(telemetry.compute_time >= 0)
+    assert np.isnan(telemetry.xnorm[-1])
+    assert np.all(telemetry.xnorm[:-1] > 0)
+    assert np.all(np.diff(telemetry.f) <= 0)
+
+
+@pytest.mark.parametrize('solver_type', [eq.NewtonRaphson, eq.SteepestDecent])
+def test_maxiter(solver_type):
+    problem = create_problem()
+
+    solver = solver_type(problem)
+    solver.maxiter = 2
+    solver.run()
+
+    # the limit is checked before the next computation
+
+    assert_equal(solver.stopping_reason, 2)
+    assert_equal(solver.iterations, 2)
+    assert_equal(solver.gevals, 2)
+    assert_equal(len(solver.telemetry), 2)
+
+
+def test_newton_raphson_timings():
+    problem = create_problem()
+
+    solver = eq.NewtonRaphson(problem)
+    solver.run()
+
+    telemetry = solver.telemetry
+
+    assert np.all(telemetry.factorize_time[:-1] > 0)
+    assert np.all(telemetry.solve_time[:-1] > 0)
+    assert_equal(telemetry.alpha[:-1], 1)
+
+
+def test_arrays_are_views():
+    problem = create_problem()
+
+    solver = eq.NewtonRaphson(problem)
+    solver.run()
+
+    rnorm = solver.telemetry.rnorm
+    expected = rnorm.copy()
+
+    assert not rnorm.flags.owndata
+    assert not rnorm.flags.writeable
+
+    # a new run does not touch arrays of the previous run
+
+    problem.x = [5.0, -5.0]
+    solver.run()
+
+    assert_equal(rnorm, expected)
+
+    del solver
+
+    assert_equal(rnorm, expected)
+
+
+def test_csv(tmp_path):
+    path = str(tmp_path / 'history.csv')
+
+    problem = create_problem()
+
+    solver = eq.NewtonRaphson(problem)
+    solver.telemetry.path = path
+    solver.run()
+
+    data = np.genfromtxt(path, delimiter=',', names=True)
+
+    assert_equal(len(data), len(solver.telemetry))
+    assert_equal(data['iteration'], np.arange(len(data)))
+    assert_almost_equal(data['rnorm'], solver.telemetry.rnorm)
+
+
+def test_json_lines(tmp_path):
+    path = str(tmp_path / 'history.jsonl')
+
+    problem = create_problem()
+
+    solver = eq.NewtonRaphson(problem)
+    solver.telemetry.path = path
+    solver.telemetry.stream_format = 'jsonl'
+    solver.run()
+
+    with open(path) as f:
+        records = [json.loads(line) for line in f]
+
+    assert_equal(len(records), len(solver.telemetry))
+    assert_almost_equal([record['f'] for record in records], solver.telemetry.f)
+    assert records[-1]['xnorm'] is None
+
+
+def test_invalid_format():
+    telemetry = eq.Telemetry()
+
+    with pytest.raises(ValueError):
+        telemetry.stream_format = 'xml'
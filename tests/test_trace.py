@@ -0,0 +1,99 @@
+import eqlib as eq
+
+import json
+import numpy as np
+import pytest
+
+from numpy.testing import assert_equal
+
+if __name__ == '__main__':
+    import sys
+    import os
+    print(f'pid: {os.getpid()}')
+    pytest.main(sys.argv)
+
+
+class Quadratic(eq.Objective):
+    def __init__(self, variables):
+        eq.Objective.__init__(self)
+        self.variables = variables
+
+    def compute(self, g, h):
+        x = np.array([variable.value for variable in self.variables])
+        if len(g) != 0:
+            g[:] = x - 1
+        if len(h) != 0:
+            h[:] = np.eye(len(x))
+        return 0.5 * np.sum((x - 1)**2)
+
+
+@pytest.fixture
+def trace():
+    eq.Trace.clear()
+    eq.Trace.enabled = True
+    yield eq.Trace
+    eq.Trace.enabled = False
+    eq.Trace.clear()
+
+
+def test_disabled():
+    eq.Trace.enabled = False
+    eq.Trace.clear()
+
+    problem = eq.Problem([Quadratic([eq.Variable(0.0), eq.Variable(3.0)])])
+    problem.compute()
+
+    assert_equal(eq.Trace.nb_events, 0)
+
+
+def test_trace(trace, tmp_path):
+    variables = [eq.Variable(0.0), eq.Variable(3.0)]
+
+    problem = eq.Problem([Quadratic(variables[:1]), Quadratic(variables[1:])], nb_threads=2, grainsize=1)
+
+    solver = eq.NewtonRaphson(problem)
+    solver.run()
+
+    path = tmp_path / 'trace.json'
+
+    trace.write(str(path))
+
+    with open(path) as file:
+        events = json.load(file)['traceEvents']
+
+    spans = [event for event in events if event['ph'] == 'X']
+
+    names = {event['name'] for event in spans}
+
+    assert {'Problem::Problem', 'unique variables', 'sparse patterns', 'Problem::compute', 'assemble', 'reduce', 'factorize', 'solve', 'NewtonRaphson iteration'} <= names
+
+    assert_equal(len(spans), trace.nb_events)
+
+    assert all(event['dur'] >= 0 for event in spans)
+
+    iterations = [event for event in spans if event['name'] == 'NewtonRaphson iteration']
+
+    assert_equal(len(iterations), solver.iterations + 1)
+
+    trace.clear()
+
+    assert_equal(trace.nb_events, 0)
+
+
+def test_async_workers_share_track(trace, tmp_path):
+    problem = eq.Problem([Quadratic([eq.Variable(0.0)])])
+
+    for _ in range(5):
+        problem.compute_async().result()
+
+    path = tmp_path / 'trace.json'
+
+    trace.write(str(path))
+
+    with open(path) as file:
+        events = json.load(file)['traceEvents']
+
+    computes = [event for event in events if event['ph'] == 'X' and event['name'] == 'Problem::compute']
+
+    assert_equal(len(computes), 5)
+    assert_equal(len({event['tid'] for event in computes}), 1)
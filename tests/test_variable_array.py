@@ -0,0 +1,81 @@
+import eqlib as eq
+
+import numpy as np
+import pytest
+
+from numpy.testing import assert_equal
+
+if __name__ == '__main__':
+    import sys
+    import os
+    print(f'pid: {os.getpid()}')
+    pytest.main(sys.argv)
+
+
+@pytest.fixture
+def variables():
+    return eq.VariableArray([1, 2, 3], [0, 0, 0], [10, 10, 10])
+
+
+def test_init(variables):
+    assert_equal(len(variables), 3)
+
+    assert_equal(variables.values, [1, 2, 3])
+    assert_equal(variables.lower_bounds, [0, 0, 0])
+    assert_equal(variables.upper_bounds, [10, 10, 10])
+    assert_equal(variables.multipliers, [1, 1, 1])
+
+    assert_equal(variables[1].value, 2)
+    assert_equal(variables[1].lower_bound, 0)
+    assert_equal(variables[1].upper_bound, 10)
+
+
+def test_init_without_bounds():
+    variables = eq.VariableArray(np.arange(4.0))
+
+    assert_equal(variables[3].value, 3)
+    assert_equal(variables[3].lower_bound, -np.inf)
+    assert_equal(variables[3].upper_bound, np.inf)
+
+
+def test_views(variables):
+    variables.values[1] = 5
+
+    assert_equal(variables[1].value, 5)
+
+    variables[2].value = 7
+
+    assert_equal(variables.values, [1, 5, 7])
+
+    variables.upper_bounds = [4, 5, 6]
+
+    assert_equal(variables[0].upper_bound, 4)
+
+    with pytest.raises(ValueError):
+        variables.values = [1, 2]
+
+
+def test_handles_keep_array_alive():
+    variable = eq.VariableArray([1, 2, 3])[1]
+
+    assert_equal(variable.value, 2)
+
+
+def test_problem(variables):
+    class Objective(eq.Objective):
+        def __init__(self, variables):
+            eq.Objective.__init__(self)
+            self.variables = variables
+
+        def compute(self, g, h):
+            return 0
+
+    problem = eq.Problem([Objective(variables.variables)])
+
+    problem.owns_variables = True
+
+    problem.x = [4, 5, 6]
+
+    problem.owns_variables = False
+
+    assert_equal(variables.values, [4, 5, 6])